@@ -0,0 +1,183 @@
+// Host-side ST7735 emulator. Interprets the command/data byte stream produced by
+// ST7735_LCD.h (CASET, RASET, RAMWR, MADCTL, COLMOD), keeps a 128x128 RGB565
+// framebuffer and counts SPI traffic per frame.
+#ifndef ST7735EMU_H
+#define ST7735EMU_H
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include "avr_host.h"
+
+#define EMU_WIDTH 128
+#define EMU_HEIGHT 128
+
+typedef struct _emuStats {
+    unsigned long bytes;      // every byte clocked out with CS low
+    unsigned long commands;   // bytes sent with A0 low
+    unsigned long pixels;     // pixels written through RAMWR (including off-panel)
+    unsigned long overdrawn;  // on-panel pixels written more than once this frame
+} emuStats;
+
+struct ST7735Emu {
+    uint16_t fb[EMU_WIDTH * EMU_HEIGHT];
+    uint8_t written[EMU_WIDTH * EMU_HEIGHT]; // per-frame write marks for overdraw
+
+    uint8_t cmd;        // command the following data bytes belong to
+    uint8_t argIndex;   // data bytes received since cmd
+    uint8_t args[4];
+    uint8_t xs, xe, ys, ye;
+    uint8_t x, y;       // RAMWR cursor, in window coordinates
+    uint8_t madctl;
+    uint8_t colmod;
+    uint8_t pixelBytes[3];
+    uint8_t pixelIndex;
+
+    emuStats frame;
+    emuStats total;
+    unsigned long frames;
+
+    /* Power-on/SWRESET controller state. Framebuffer contents and counters survive. */
+    void reset() {
+        cmd = 0;
+        argIndex = 0;
+        xs = 0; xe = EMU_WIDTH - 1;
+        ys = 0; ye = EMU_HEIGHT - 1;
+        x = 0; y = 0;
+        madctl = 0;
+        colmod = 0x06; // controller default is 18-bit
+        pixelIndex = 0;
+    }
+
+    void write(uint8_t data, uint8_t dc) {
+        frame.bytes++;
+        if (!dc) {
+            frame.commands++;
+            cmd = data;
+            argIndex = 0;
+            if (cmd == 0x01) { reset(); return; } // SWRESET
+            if (cmd == 0x2C) { x = xs; y = ys; pixelIndex = 0; } // RAMWR
+            return;
+        }
+        switch (cmd) {
+            case 0x2A: // CASET: xs16, xe16
+            case 0x2B: // RASET: ys16, ye16
+                if (argIndex < 4) { args[argIndex] = data; }
+                argIndex++;
+                if (argIndex == 4) {
+                    if (cmd == 0x2A) { xs = args[1]; xe = args[3]; }
+                    else { ys = args[1]; ye = args[3]; }
+                }
+                break;
+            case 0x36: madctl = data; break; // MADCTL
+            case 0x3A: colmod = data & 0x07; break; // COLMOD
+            case 0x2C: pixelData(data); break; // RAMWR
+            default: break;
+        }
+    }
+
+    void pixelData(uint8_t data) {
+        uint8_t bytesPerPixel = (colmod == 0x05) ? 2 : 3;
+        pixelBytes[pixelIndex++] = data;
+        if (pixelIndex < bytesPerPixel) { return; }
+        pixelIndex = 0;
+
+        uint16_t color;
+        if (bytesPerPixel == 2) {
+            color = (pixelBytes[0] << 8) | pixelBytes[1];
+        } else { // 18-bit: top 6 bits of each byte
+            color = ((pixelBytes[0] & 0xF8) << 8) | ((pixelBytes[1] & 0xFC) << 3) | (pixelBytes[2] >> 3);
+        }
+        plot(x, y, color);
+
+        // column address advances first, then row, wrapping inside the window
+        if (x >= xe) {
+            x = xs;
+            y = (y >= ye) ? ys : y + 1;
+        } else {
+            x++;
+        }
+    }
+
+    /* Maps a controller RAM address to the panel through MADCTL MX/MY/MV and stores it. */
+    void plot(uint8_t col, uint8_t row, uint16_t color) {
+        frame.pixels++;
+        unsigned int px = col;
+        unsigned int py = row;
+        if (madctl & 0x20) { unsigned int t = px; px = py; py = t; } // MV
+        if (madctl & 0x40) { px = EMU_WIDTH - 1 - px; }              // MX
+        if (madctl & 0x80) { py = EMU_HEIGHT - 1 - py; }             // MY
+        if (px >= EMU_WIDTH || py >= EMU_HEIGHT) { return; }
+        unsigned int k = py * EMU_WIDTH + px;
+        if (written[k]) { frame.overdrawn++; }
+        written[k] = 1;
+        fb[k] = color;
+    }
+
+    /* Closes the current frame: folds its counters into the totals and returns them. */
+    emuStats endFrame() {
+        emuStats done = frame;
+        total.bytes += frame.bytes;
+        total.commands += frame.commands;
+        total.pixels += frame.pixels;
+        total.overdrawn += frame.overdrawn;
+        frames++;
+        memset(&frame, 0, sizeof(frame));
+        memset(written, 0, sizeof(written));
+        return done;
+    }
+
+    static void toRGB888(uint16_t color, uint8_t *rgb) {
+        rgb[0] = ((color >> 11) & 0x1F) * 255 / 31;
+        rgb[1] = ((color >> 5) & 0x3F) * 255 / 63;
+        rgb[2] = (color & 0x1F) * 255 / 31;
+    }
+
+    /* Writes the framebuffer as a binary PPM. Returns 0 on success. */
+    int writePPM(const char *path) const {
+        FILE *f = fopen(path, "wb");
+        if (!f) { return -1; }
+        fprintf(f, "P6\n%d %d\n255\n", EMU_WIDTH, EMU_HEIGHT);
+        for (unsigned int k = 0; k < EMU_WIDTH * EMU_HEIGHT; k++) {
+            uint8_t rgb[3];
+            toRGB888(fb[k], rgb);
+            fwrite(rgb, 1, 3, f);
+        }
+        return fclose(f);
+    }
+
+    /* Compares the framebuffer against a PPM written by writePPM.
+       Returns the number of differing pixels, or -1 if the file can't be read. */
+    long comparePPM(const char *path) const {
+        long diff = -1;
+        FILE *f = fopen(path, "rb");
+        int w, h, maxval;
+        if (f && fscanf(f, "P6 %d %d %d", &w, &h, &maxval) == 3 && w == EMU_WIDTH && h == EMU_HEIGHT) {
+            fgetc(f);
+            diff = 0;
+            for (unsigned int k = 0; k < EMU_WIDTH * EMU_HEIGHT; k++) {
+                uint8_t rgb[3], ours[3];
+                if (fread(rgb, 1, 3, f) != 3) { diff = -1; break; }
+                toRGB888(fb[k], ours);
+                if (memcmp(rgb, ours, 3) != 0) { diff++; }
+            }
+        }
+        if (f) { fclose(f); }
+        return diff;
+    }
+};
+
+// The emulator instance fed by host_spi_hook. Bytes sent with CS high are ignored,
+// like the real panel does.
+inline ST7735Emu st7735emu;
+
+inline void st7735emu_spi(uint8_t data, uint8_t dc, uint8_t cs) {
+    if (!cs) { st7735emu.write(data, dc); }
+}
+
+inline void st7735emu_attach() {
+    memset(&st7735emu, 0, sizeof(st7735emu));
+    st7735emu.reset();
+    host_spi_hook = &st7735emu_spi;
+}
+
+#endif /* ST7735EMU_H */
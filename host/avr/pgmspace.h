@@ -0,0 +1,2 @@
+// Host stand-in, see avr_host.h
+#include "../avr_host.h"
@@ -0,0 +1,167 @@
+// Host (Linux) stand-ins for the ATmega328 registers and avr-libc calls used by
+// the headers in include/. Only compiled by the [env:native] build, which puts
+// this directory first on the include path so <avr/io.h> and friends land here.
+#ifndef AVR_HOST_H
+#define AVR_HOST_H
+#include <stdint.h>
+#include <poll.h>
+#include <unistd.h>
+
+////////// SIMULATED CLOCK ///////////
+// Every _delay_ms/_delay_us and SPI byte advances this, so host runs can report
+// how long the AVR would have spent blocked.
+inline unsigned long long host_clock_us = 0;
+
+inline void _delay_ms(double ms) { host_clock_us += (unsigned long long)(ms * 1000); }
+inline void _delay_us(double us) { host_clock_us += (unsigned long long)us; }
+
+////////// PLAIN REGISTERS ///////////
+inline volatile uint8_t DDRB, PORTB, PINB;
+inline volatile uint8_t DDRC, PORTC, PINC;
+inline volatile uint8_t DDRD, PORTD, PIND;
+inline volatile uint8_t SREG;
+inline volatile uint8_t SPCR;
+inline volatile uint8_t SPSR = 0x80; // SPIF always set: transfers complete instantly
+inline volatile uint8_t ADMUX, ADCL, ADCH;
+inline volatile uint8_t TCCR1A, TCCR1B, TIMSK1;
+inline volatile uint8_t TCCR2A, TCCR2B, OCR2A, TCNT2, TIMSK2;
+
+////////// TIMER1 COUNTER ///////////
+// Counts host_clock_us at the prescaler selected in TCCR1B. Each read costs 1 us,
+// so loops that poll it make progress.
+struct HostTCNT1 {
+    unsigned long long zero; // host_clock_us when the count was 0, scaled by 16
+    static unsigned long prescaler() {
+        static const unsigned int div[8] = {0, 1, 8, 64, 256, 1024, 0, 0};
+        return div[TCCR1B & 0x07];
+    }
+    void operator=(uint16_t value) { zero = host_clock_us * 16 - (unsigned long long)value * prescaler(); }
+    operator uint16_t() const {
+        host_clock_us++;
+        if (!prescaler()) { return 0; }
+        return (uint16_t)((host_clock_us * 16 - zero) / prescaler());
+    }
+};
+inline HostTCNT1 TCNT1;
+
+////////// SPI DATA REGISTER ///////////
+// Writes to SPDR are handed to host_spi_hook together with the ST7735 A0 (PB1)
+// and CS (PB2) lines, so an emulator sees exactly the bytes the driver clocks out.
+inline void (*host_spi_hook)(uint8_t data, uint8_t dc, uint8_t cs) = 0;
+
+struct HostSPDR {
+    uint8_t last;
+    void operator=(uint8_t data) {
+        last = data;
+        host_clock_us += 2; // 8 bits at clk/4
+        if (host_spi_hook) { host_spi_hook(data, (PORTB >> 1) & 0x01, (PORTB >> 2) & 0x01); }
+    }
+    operator uint8_t() const { return last; }
+};
+inline HostSPDR SPDR;
+
+////////// ADC ///////////
+// Setting ADSC converts immediately from host_adc[channel] and clears ADSC.
+inline unsigned int host_adc[8];
+
+struct HostADCSRA {
+    uint8_t value;
+    void operator|=(uint8_t bits) {
+        value |= bits;
+        if (value & (1 << 6)) { // ADSC
+            unsigned int result = host_adc[ADMUX & 0x07] & 0x3FF;
+            ADCL = result & 0xFF;
+            ADCH = result >> 8;
+            value &= ~(1 << 6);
+        }
+    }
+    void operator&=(uint8_t bits) { value &= bits; }
+    void operator=(uint8_t bits) { value = 0; *this |= bits; }
+    operator uint8_t() const { return value; }
+};
+inline HostADCSRA ADCSRA;
+
+////////// UART ///////////
+// UDR0 reads and writes go to host_uart_fd (e.g. one side of a pty pair);
+// UCSR0A reports RXC0 when that descriptor has a byte waiting.
+inline int host_uart_fd = -1;
+inline volatile uint16_t UBRR0;
+inline volatile uint8_t UCSR0B, UCSR0C;
+
+struct HostUCSR0A {
+    operator uint8_t() const {
+        uint8_t value = 1 << 5; // UDRE0: always ready to transmit
+        struct pollfd p = { host_uart_fd, POLLIN, 0 };
+        if (host_uart_fd >= 0 && poll(&p, 1, 0) == 1 && (p.revents & POLLIN)) { value |= 1 << 7; } // RXC0
+        return value;
+    }
+};
+inline HostUCSR0A UCSR0A;
+
+struct HostUDR0 {
+    void operator=(uint8_t data) {
+        if (host_uart_fd >= 0 && write(host_uart_fd, &data, 1) != 1) {}
+    }
+    operator uint8_t() const {
+        uint8_t data = 0;
+        if (host_uart_fd >= 0 && read(host_uart_fd, &data, 1) != 1) { data = 0; }
+        return data;
+    }
+};
+inline HostUDR0 UDR0;
+
+////////// BIT NAMES ///////////
+#define PORTB0 0
+#define PORTB1 1
+#define PORTB2 2
+#define PORTB3 3
+#define PORTB4 4
+#define PORTB5 5
+#define SPIF 7
+#define SPE 6
+#define MSTR 4
+#define REFS0 6
+#define ADEN 7
+#define ADSC 6
+#define ADPS2 2
+#define ADPS1 1
+#define ADPS0 0
+#define TOIE1 0
+#define OCIE2A 1
+#define CS10 0
+#define CS11 1
+#define CS12 2
+#define TXEN0 3
+#define RXEN0 4
+#define RXCIE0 7
+#define UCSZ00 1
+#define UDRE0 5
+#define DOR0 3
+#define RXC0 7
+
+////////// PROGRAM MEMORY ///////////
+// Flash and RAM share one address space here.
+#define PROGMEM
+#define PSTR(s) (s)
+#define pgm_read_byte(addr) (*(const uint8_t *)(addr))
+#define pgm_read_word(addr) (*(const uint16_t *)(addr))
+#define pgm_read_ptr(addr) (*(void * const *)(addr))
+
+////////// WATCHDOG ///////////
+// Never fires on the host; MCUSR reads as a power-on reset.
+inline volatile uint8_t MCUSR = 0x01;
+#define PORF 0
+#define EXTRF 1
+#define BORF 2
+#define WDRF 3
+#define WDTO_500MS 5
+inline void wdt_enable(uint8_t) {}
+inline void wdt_disable() {}
+inline void wdt_reset() {}
+
+////////// INTERRUPTS ///////////
+#define ISR(vector) void vector(void)
+inline void sei() { SREG |= 0x80; }
+inline void cli() { SREG &= ~0x80; }
+
+#endif /* AVR_HOST_H */
@@ -0,0 +1,64 @@
+// Game<Display, Input, Clock> backends that only exist on the host.
+#ifndef HOST_BACKENDS_H
+#define HOST_BACKENDS_H
+#include "avr_host.h"
+#include "ST7735Emu.h"
+#include "sprite.h"
+
+/* Draws nothing; for headless runs at full speed. */
+struct NullDisplay {
+    static inline void fill(unsigned char, unsigned char, unsigned char, unsigned char, short) {}
+    static inline void glyph(unsigned char, unsigned char, const unsigned char *, unsigned char, unsigned char,
+                             unsigned char, short, short) {}
+    static inline void blit(unsigned char, unsigned char, const sprite *, const unsigned short *) {}
+    static inline void textClear() {}
+    static inline void textGoto(unsigned char, unsigned char) {}
+    static inline void textChar(char) {}
+    static inline void textStr(const char *) {}
+    static inline void textStrP(const char *) {}
+};
+
+/* Fills straight into the emulator framebuffer, skipping the SPI byte stream.
+   Same picture as AvrDisplay, for quick visual checks. */
+struct FramebufferDisplay {
+    static inline void fill(unsigned char xs, unsigned char xe, unsigned char ys, unsigned char ye, short color) {
+        for (unsigned int y = ys; y <= ye; y++) {
+            for (unsigned int x = xs; x <= xe; x++) { st7735emu.plot(x, y, color); }
+        }
+    }
+    static inline void glyph(unsigned char xs, unsigned char ys, const unsigned char *rows, unsigned char w, unsigned char h,
+                             unsigned char scale, short fg, short bg) {
+        for (unsigned int r = 0; r < (unsigned int)h * scale; r++) {
+            unsigned char bits = pgm_read_byte(&rows[r / scale]);
+            for (unsigned int c = 0; c < (unsigned int)w * scale; c++) {
+                st7735emu.plot(xs + c, ys + r, (bits & (1 << (w - 1 - c / scale))) ? fg : bg);
+            }
+        }
+    }
+    static inline void blit(unsigned char xs, unsigned char ys, const sprite *s, const unsigned short *palette) {
+        unsigned int w = pgm_read_byte(&s->width);
+        const unsigned char *runs = (const unsigned char *)pgm_read_ptr(&s->runs);
+        unsigned int p = 0;
+        if (!palette) { palette = (const unsigned short *)pgm_read_ptr(&s->palette); }
+        for (unsigned int i = 0; i < pgm_read_word(&s->runCount); i++) {
+            unsigned char run = pgm_read_byte(&runs[i]);
+            for (unsigned int n = SPRITE_RUN_LENGTH(run); n; n--, p++) {
+                st7735emu.plot(xs + p % w, ys + p / w, pgm_read_word(&palette[SPRITE_RUN_INDEX(run)]));
+            }
+        }
+    }
+    static inline void textClear() {}
+    static inline void textGoto(unsigned char, unsigned char) {}
+    static inline void textChar(char) {}
+    static inline void textStr(const char *) {}
+    static inline void textStrP(const char *) {}
+};
+
+/* The simulated clock: time spent in delays and SPI transfers. */
+struct HostClock {
+    static const unsigned int US_PER_COUNT = 1;
+    static inline void start() {}
+    static inline unsigned int now() { return (unsigned int)host_clock_us; }
+};
+
+#endif /* HOST_BACKENDS_H */
@@ -2,6 +2,7 @@
 #define LCD_H_
 #include <avr/io.h>
 #include <util/delay.h>
+#include <avr/pgmspace.h>
 #define DATA_BUS PORTD
 #define CTL_BUS PORTD
 #define DATA_DDR DDRD
@@ -75,6 +76,14 @@ void lcd_write_str(char* str)
         i++;
     }
 }
+void lcd_write_str_P(const char* str)
+{
+    char c;
+    while((c = pgm_read_byte(str++)) != '\0')
+    {
+        lcd_write_character(c);
+    }
+}
 void lcd_clear()
 {
     lcd_send_command(LCD_CMD_CLEAR_DISPLAY);
@@ -8,9 +8,12 @@ MOS(SDA) - 11 - B3
 CSK(SCK) - 13 - B5
 LED - 3.3V
 */
-
+#ifndef ST7735_LCD_H
+#define ST7735_LCD_H
+#include <avr/pgmspace.h>
 #include "helper.h"
 #include "SPI_AVR.h"
+#include "sprite.h"
 
 const char SWRESET = 0x01;
 const char CASET = 0x2A;
@@ -59,13 +62,10 @@ void ST7735_init() {
 }
 
 /* 
-Inputs: xs (x start), xe (x end), ys (y start), ye (y end), color (16 bits)
-Fill in the entire rectangle with the color
+Inputs: xs (x start), xe (x end), ys (y start), ye (y end)
+Set the CASET/RASET window and start a RAMWR; pixels then fill it row by row
 */
-void displayBlock(unsigned char xs, unsigned char xe, unsigned char ys, unsigned char ye, short color) {
-    unsigned int i, j;
-
-    // set location of block
+void displayWindow(unsigned char xs, unsigned char xe, unsigned char ys, unsigned char ye) {
     Send_Command(CASET);
     Send_Data(0);
     Send_Data(xs);
@@ -76,9 +76,20 @@ void displayBlock(unsigned char xs, unsigned char xe, unsigned char ys, unsigned
     Send_Data(ys);
     Send_Data(0);
     Send_Data(ye);
+    Send_Command(RAMWR);
+}
+
+/* 
+Inputs: xs (x start), xe (x end), ys (y start), ye (y end), color (16 bits)
+Fill in the entire rectangle with the color
+*/
+void displayBlock(unsigned char xs, unsigned char xe, unsigned char ys, unsigned char ye, short color) {
+    unsigned int i, j;
+
+    // set location of block
+    displayWindow(xs, xe, ys, ye);
 
     // set block color
-    Send_Command(RAMWR);
     for (i = 0; i <= uint16_t(xe - xs); i++) {
         for (j = 0; j <= uint16_t(ye - ys); j++) {
             Send_Data((color & 0xFF00) >> 8);
@@ -86,4 +97,49 @@ void displayBlock(unsigned char xs, unsigned char xe, unsigned char ys, unsigned
         }
     }
     return;
-}
\ No newline at end of file
+}
+
+/* 
+Inputs: xs, ys (top left corner), rows (h bytes in PROGMEM, bit w-1 is the leftmost pixel),
+w, h (glyph size), scale (pixels per glyph pixel), fg, bg (16 bit colors)
+Draw a 1-bit glyph through one window, every pixel written once
+*/
+void displayGlyph(unsigned char xs, unsigned char ys, const unsigned char *rows, unsigned char w, unsigned char h,
+                  unsigned char scale, short fg, short bg) {
+    unsigned char r, c;
+    short color;
+
+    displayWindow(xs, xs + w * scale - 1, ys, ys + h * scale - 1);
+    for (r = 0; r < h * scale; r++) {
+        unsigned char bits = pgm_read_byte(&rows[r / scale]);
+        for (c = 0; c < w * scale; c++) {
+            color = (bits & (1 << (w - 1 - c / scale))) ? fg : bg;
+            Send_Data((color & 0xFF00) >> 8);
+            Send_Data(color & 0x00FF);
+        }
+    }
+}
+/* 
+Inputs: xs, ys (top left corner), s (sprite in PROGMEM), palette (PROGMEM colors, 0 for the sprite's own)
+Stream a run-length encoded sprite into one window as its runs are read, without a buffer
+*/
+void displaySprite(unsigned char xs, unsigned char ys, const sprite *s, const unsigned short *palette) {
+    unsigned char w = pgm_read_byte(&s->width);
+    unsigned char h = pgm_read_byte(&s->height);
+    unsigned short count = pgm_read_word(&s->runCount);
+    const unsigned char *runs = (const unsigned char *)pgm_read_ptr(&s->runs);
+    unsigned short i;
+    unsigned char n;
+
+    if (!palette) { palette = (const unsigned short *)pgm_read_ptr(&s->palette); }
+    displayWindow(xs, xs + w - 1, ys, ys + h - 1);
+    for (i = 0; i < count; i++) {
+        unsigned char run = pgm_read_byte(&runs[i]);
+        unsigned short color = pgm_read_word(&palette[SPRITE_RUN_INDEX(run)]);
+        for (n = SPRITE_RUN_LENGTH(run); n; n--) {
+            Send_Data(color >> 8);
+            Send_Data(color & 0x00FF);
+        }
+    }
+}
+#endif /* ST7735_LCD_H */
@@ -0,0 +1,75 @@
+#ifndef BACKENDS_H
+#define BACKENDS_H
+#include <avr/io.h>
+#include "helper.h"
+#include "periph.h"
+#include "ST7735_LCD.h"
+#include "LCD1602.h"
+#ifdef LOCKSTEP
+#include "lockstep.h"
+#endif
+
+// Game<Display, Input, Clock> backends for the ATmega328 board.
+
+/* ST7735 for the playfield, LCD1602 for scores and messages. */
+struct AvrDisplay {
+    static inline void fill(unsigned char xs, unsigned char xe, unsigned char ys, unsigned char ye, short color) {
+        displayBlock(xs, xe, ys, ye, color);
+    }
+    static inline void glyph(unsigned char x, unsigned char y, const unsigned char *rows, unsigned char w, unsigned char h,
+                             unsigned char scale, short fg, short bg) {
+        displayGlyph(x, y, rows, w, h, scale, fg, bg);
+    }
+    static inline void blit(unsigned char x, unsigned char y, const sprite *s, const unsigned short *palette) {
+        displaySprite(x, y, s, palette);
+    }
+    static inline void textClear() { lcd_clear(); }
+    static inline void textGoto(unsigned char line, unsigned char pos) { lcd_goto_xy(line, pos); }
+    static inline void textChar(char c) { lcd_write_character(c); }
+    static inline void textStr(const char *str) { lcd_write_str((char *)str); }
+    static inline void textStrP(const char *str) { lcd_write_str_P(str); }
+};
+
+/* Potentiometers on ADC1/ADC2, start button on PC3, player mode button on PC4. */
+struct PotInput {
+    static inline unsigned char paddle(unsigned char player) { return map(ADC_read(player), 40, 1024, 0, 102); }
+    static inline unsigned char startButton() { return GetBit(PINC, 3); }
+    static inline unsigned char toggleButton() { return GetBit(PINC, 4); }
+    static inline unsigned char linkError() { return 0; }
+};
+
+#ifdef LOCKSTEP
+/* Inputs of the tick being simulated, as agreed over the lockstep link. Either
+   board's start button counts; games are always two player. */
+struct LockstepInput {
+    static inline unsigned char paddle(unsigned char player) { return lsPaddle[player - 1]; }
+    static inline unsigned char startButton() { return lsButton; }
+    static inline unsigned char toggleButton() { return 0; }
+    static inline unsigned char linkError() { return lsDesync; }
+};
+
+/* One scheduler period in lockstep mode: exchange inputs, and advance game time
+   with G::tick() only once the other board's input for the tick is in. */
+template <class G>
+void lockstepTick() {
+    lockstep_poll();
+    lockstep_send(PotInput::paddle(lsRole), PotInput::startButton());
+    if (!lockstep_ready()) { return; }
+    lockstep_step();
+    G::tick();
+    lockstep_receive(); // before the UART's buffer fills
+    lockstep_commit(G::gameChecksum());
+}
+#endif
+
+/* Timer1 free running at clk/256, 16 us per count. */
+struct Timer1Clock {
+    static const unsigned int US_PER_COUNT = 16;
+    static inline void start() {
+        TCCR1A = 0;
+        TCCR1B = (1 << CS12);
+    }
+    static inline unsigned int now() { return TCNT1; }
+};
+
+#endif /* BACKENDS_H */
@@ -0,0 +1,135 @@
+#ifndef BOOT_H
+#define BOOT_H
+#include <avr/io.h>
+#include <util/delay.h>
+#include <avr/pgmspace.h>
+#include "helper.h"
+#include "periph.h"
+#include "ST7735_LCD.h"
+#include "LCD1602.h"
+
+// Power-up as a time-driven sequence instead of back-to-back _delay_ms calls.
+// Each peripheral is a track of steps; after a step runs, its track waits
+// waitMs before the next one. The tracks interleave, so the LCD1602 and ADC
+// are brought up inside the ST7735's reset and sleep-out waits.
+// Time is read from Timer1 at clk/1024 (64 us per count). The step tables live
+// in flash.
+
+typedef struct _bootStep {
+    void (*fn)(void); // 0 for a plain wait
+    unsigned char waitMs; // wait before the track's next step
+} bootStep;
+
+typedef struct _bootTrack {
+    const bootStep *steps; // in PROGMEM
+    unsigned char count;
+    unsigned char next; // index of the next step to run
+    unsigned int dueAt; // Timer1 count when the next step may run
+} bootTrack;
+
+#define BOOT_TICKS(ms) ((unsigned int)((ms) * 1000UL / 64))
+
+unsigned int bootTimeMs = 0; // measured time from boot_run() to the first (cleared) frame on the panel
+
+////////// ST7735 TRACK ///////////
+// Waits are the datasheet minimums: 120 ms after a reset and after SLPOUT.
+void st7735Reset() {
+    PORTB = SetBit(PORTB, 0, 0); // reset pulse, at least 10 us
+    _delay_us(10);
+    PORTB = SetBit(PORTB, 0, 1);
+}
+
+void st7735SoftReset() { Send_Command(SWRESET); }
+
+void st7735SleepOut() { Send_Command(SLPOUT); }
+
+void st7735Setup() {
+    Send_Command(COLMOD);
+    Send_Data(0x05); // for 16 bit color mode
+    Send_Command(MADCTL);
+    Send_Data(0b00001000); // screen color and orientation settings
+}
+
+// clear the power-up garbage before the display is switched on
+void st7735Clear() { displayBlock(0, 129, 0, 129, 0x0000); }
+
+void st7735DisplayOn() { Send_Command(DISPON); }
+
+const bootStep st7735Steps[] PROGMEM = {
+    {st7735Reset, 120},
+    {st7735SoftReset, 120},
+    {st7735SleepOut, 120},
+    {st7735Setup, 0},
+    {st7735Clear, 0},
+    {st7735DisplayOn, 0},
+};
+
+////////// LCD1602 TRACK ///////////
+// Same commands as lcd_init(), after the 40 ms the HD44780 needs from power-up.
+void lcdWake() {
+    DATA_DDR = (1<<LCD_D7) | (1<<LCD_D6) | (1<<LCD_D5)| (1<<LCD_D4);
+    CTL_DDR |= (1<<LCD_EN)|(1<<LCD_RS);
+    DATA_BUS = (0<<LCD_D7)|(0<<LCD_D6)|(1<<LCD_D5)|(0<<LCD_D4);
+    CTL_BUS|= (1<<LCD_EN)|(0<<LCD_RS);
+}
+
+void lcdWakeLatch() { CTL_BUS &=~(1<<LCD_EN); }
+
+void lcdFunctionSet() { lcd_send_command(LCD_CMD_4BIT_2ROW_5X7); }
+
+void lcdDisplayOn() { lcd_send_command(LCD_CMD_DISPLAY_CURSOR_BLINK); }
+
+void lcdHome() { lcd_send_command(0x80); }
+
+const bootStep lcdSteps[] PROGMEM = {
+    {0, 40},
+    {lcdWake, 1},
+    {lcdWakeLatch, 1},
+    {lcdFunctionSet, 1},
+    {lcdDisplayOn, 1},
+    {lcdHome, 0},
+};
+
+////////// ADC TRACK ///////////
+// The first conversion after enabling the ADC takes 25 ADC clocks instead of 13;
+// do it on both paddle channels now rather than in the first game tick.
+void adcWarmUp() {
+    ADC_read(1);
+    ADC_read(2);
+}
+
+const bootStep adcSteps[] PROGMEM = {
+    {ADC_init, 0},
+    {adcWarmUp, 0},
+};
+
+/* Runs all tracks to completion and records bootTimeMs. Call after SPI_INIT(). */
+void boot_run() {
+    bootTrack tracks[] = {
+        {st7735Steps, sizeof(st7735Steps) / sizeof(bootStep), 0, 0},
+        {lcdSteps, sizeof(lcdSteps) / sizeof(bootStep), 0, 0},
+        {adcSteps, sizeof(adcSteps) / sizeof(bootStep), 0, 0},
+    };
+    const unsigned char numTracks = sizeof(tracks) / sizeof(bootTrack);
+    unsigned char pending;
+
+    TCCR1A = 0;
+    TCCR1B = (1 << CS12) | (1 << CS10); // clk/1024
+    TCNT1 = 0;
+    do {
+        pending = 0;
+        for (unsigned char t = 0; t < numTracks; t++) {
+            bootTrack *track = &tracks[t];
+            if (track->next >= track->count) { continue; }
+            pending = 1;
+            if (TCNT1 < track->dueAt) { continue; }
+            const bootStep *step = &track->steps[track->next++];
+            void (*fn)(void) = (void (*)(void))pgm_read_ptr(&step->fn);
+            if (fn) { fn(); }
+            track->dueAt = TCNT1 + BOOT_TICKS(pgm_read_byte(&step->waitMs));
+        }
+    } while (pending);
+    bootTimeMs = (unsigned long)TCNT1 * 64 / 1000;
+}
+
+#endif /* BOOT_H */
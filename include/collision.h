@@ -0,0 +1,61 @@
+#ifndef COLLISION_H
+#define COLLISION_H
+#include <avr/pgmspace.h>
+
+// Paddle deflection table. A ball touching a paddle is classified by d, its
+// bottom edge measured from the paddle's top edge: d = 0 is the first row the
+// ball can touch and d = width + ball diameter is the last. The paddle is split
+// into PADDLE_ZONES zones of roughly equal size, and each zone adds its own
+// amount to the ball's y velocity: the further from the middle, the more.
+// With 3 zones over the 26 px paddle this reproduces the original fixed 8 px
+// zones (+1, -1, +1).
+
+#ifndef PADDLE_ZONES
+#define PADDLE_ZONES 3
+#endif
+
+/* Last offset of zone k - 1. The edges are placed symmetrically from both ends. */
+constexpr unsigned char zoneEdge(unsigned char k, unsigned char zones, unsigned char width) {
+    return 2 * k < zones ? k * width / zones : width - (zones - k) * width / zones;
+}
+
+/* Zone of offset d: the number of zone edges it lies past. */
+constexpr unsigned char zoneOf(unsigned char d, unsigned char zones, unsigned char width, unsigned char k = 1) {
+    return k >= zones ? 0 : (d > zoneEdge(k, zones, width)) + zoneOf(d, zones, width, k + 1);
+}
+
+/* Change to the ball's y velocity for a hit in zone z: twice the distance from
+   the middle zone, in half zones, minus one. */
+constexpr signed char zoneDeflect(unsigned char z, unsigned char zones) {
+    return (2 * z > zones - 1 ? 2 * z - (zones - 1) : (zones - 1) - 2 * z) - 1;
+}
+
+constexpr signed char paddleDeflect(unsigned char d, unsigned char zones, unsigned char width) {
+    return zoneDeflect(zoneOf(d, zones, width), zones);
+}
+
+static_assert(paddleDeflect(0, 3, 26) == 1 && paddleDeflect(8, 3, 26) == 1 &&
+              paddleDeflect(9, 3, 26) == -1 && paddleDeflect(18, 3, 26) == -1 &&
+              paddleDeflect(19, 3, 26) == 1 && paddleDeflect(30, 3, 26) == 1,
+              "3 zones must match the original 8 px paddle zones");
+
+/* deflectTable<Width, Ball, Zones>::table holds paddleDeflect for every offset
+   0 .. Width + Ball, in flash. Built by expanding a pack of the offsets. */
+template <unsigned char Width, unsigned char Ball, unsigned char Zones, unsigned char N, unsigned char... D>
+struct deflectTableOf : deflectTableOf<Width, Ball, Zones, N - 1, N - 1, D...> {};
+
+template <unsigned char Width, unsigned char Ball, unsigned char Zones, unsigned char... D>
+struct deflectTableOf<Width, Ball, Zones, 0, D...> {
+    static const unsigned char SIZE = sizeof...(D);
+    static const signed char table[sizeof...(D)];
+};
+
+template <unsigned char Width, unsigned char Ball, unsigned char Zones, unsigned char... D>
+const signed char deflectTableOf<Width, Ball, Zones, 0, D...>::table[sizeof...(D)] PROGMEM = {
+    paddleDeflect(D, Zones, Width)...
+};
+
+template <unsigned char Width, unsigned char Ball, unsigned char Zones>
+struct deflectTable : deflectTableOf<Width, Ball, Zones, Width + Ball + 1> {};
+
+#endif /* COLLISION_H */
@@ -0,0 +1,72 @@
+#ifndef COROUTINE_H
+#define COROUTINE_H
+
+// Stackless coroutines (protothread style) for task tick functions. A coroutine
+// is a function taking its context struct; each call resumes where the last
+// CO_YIELD left off, so multi-tick work can be written as ordinary loops instead
+// of a state enum plus static locals. Locals do not survive a yield: keep them in
+// the context struct. A coroutine body must not contain its own switch statement.
+//
+//   char Co_Example(exampleCo *c) {
+//       CO_BEGIN(&c->co);
+//       for (c->i = 0; c->i < 10; c->i++) { ...; CO_YIELD(&c->co); }
+//       CO_END(&c->co);
+//   }
+//   int Tick_Example(int state) { Co_Example(&example); return state; }
+
+#define CO_RUNNING 0
+#define CO_DONE 1
+
+typedef struct _coroutine {
+    unsigned short line; // where to resume, 0 = from the top
+} coroutine;
+
+#define CO_BEGIN(co) switch ((co)->line) { case 0:
+#define CO_YIELD(co) do { (co)->line = __LINE__; return CO_RUNNING; case __LINE__:; } while (0)
+#define CO_WAIT_UNTIL(co, cond) do { (co)->line = __LINE__; case __LINE__: if (!(cond)) { return CO_RUNNING; } } while (0)
+#define CO_END(co) } (co)->line = 0; return CO_DONE
+#define CO_RESET(co) ((co)->line = 0)
+
+////////// CHUNKED BLOCK FILL ///////////
+// Fills a rectangle a band of rows at a time, yielding after about
+// FILL_CHUNK_PIXELS pixels so a full screen clear spreads over several ticks.
+#define FILL_CHUNK_PIXELS 1024
+
+typedef struct _blockFill {
+    coroutine co;
+    unsigned char active;
+    unsigned char xs, xe, ys, ye;
+    short color;
+    unsigned char row; // next row to fill
+    unsigned char rows; // rows per chunk
+} blockFill;
+
+/* Starts (or restarts) a chunked fill. The pixels are drawn by later calls to Co_Fill. */
+void fillStart(blockFill *f, unsigned char xs, unsigned char xe, unsigned char ys, unsigned char ye, short color) {
+    unsigned int width = xe - xs + 1;
+    f->xs = xs;
+    f->xe = xe;
+    f->ys = ys;
+    f->ye = ye;
+    f->color = color;
+    f->rows = (width >= FILL_CHUNK_PIXELS) ? 1 : FILL_CHUNK_PIXELS / width;
+    f->active = 1;
+    CO_RESET(&f->co);
+}
+
+/* Draws the next chunk of a fill through Display::fill. Returns CO_DONE once the
+   whole rectangle is drawn. */
+template <class Display>
+char Co_Fill(blockFill *f) {
+    if (!f->active) { return CO_DONE; }
+    CO_BEGIN(&f->co);
+    for (f->row = f->ys; f->row + f->rows <= f->ye; f->row += f->rows) {
+        Display::fill(f->xs, f->xe, f->row, f->row + f->rows - 1, f->color);
+        CO_YIELD(&f->co);
+    }
+    Display::fill(f->xs, f->xe, f->row, f->ye, f->color);
+    f->active = 0;
+    CO_END(&f->co);
+}
+
+#endif /* COROUTINE_H */
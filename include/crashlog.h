@@ -0,0 +1,76 @@
+#ifndef CRASHLOG_H
+#define CRASHLOG_H
+
+// Watchdog post-mortem. The scheduler notes which task it is about to run, and
+// how long the last few tasks took, in a crash record kept in .noinit: the C
+// runtime neither copies nor clears it, so it still holds the last tick when the
+// watchdog resets a hung unit. A tick that was started but never finished is
+// the crash itself; watchdog.h prints it on the next boot. Times are kept as
+// raw clock counts, so the hooks cost no multiplies inside the tick; 16 bits of
+// Timer1 counts outlast the watchdog timeout.
+
+#define CRASH_MAGIC 0xC4A5
+#define CRASH_TIMINGS 8 // task runs kept
+#define CRASH_IDLE 0xFF // task value between tasks
+
+typedef struct _taskTiming {
+    unsigned char task;
+    unsigned short counts; // run time, in clock counts
+} taskTiming;
+
+typedef struct _crashRecord {
+    unsigned short magic; // CRASH_MAGIC once initialized
+    unsigned char inTick; // 1 from the start of a tick until it finishes
+    unsigned char task; // task being run, or CRASH_IDLE
+    signed char state; // its state when it was called
+    unsigned short taskStartCounts; // when it was called, clock counts from the start of the tick
+    unsigned long ticks; // ticks started since boot
+    unsigned char next; // slot in timings for the next run, the oldest one
+    taskTiming timings[CRASH_TIMINGS];
+} crashRecord;
+
+crashRecord crashLog __attribute__((section(".noinit")));
+
+/* Starts a fresh record. The .noinit contents are garbage after power-up, so
+   this runs before the scheduler does. */
+void crash_clear(void) {
+    crashLog.magic = CRASH_MAGIC;
+    crashLog.inTick = 0;
+    crashLog.task = CRASH_IDLE;
+    crashLog.ticks = 0;
+    crashLog.next = 0;
+    for (unsigned char i = 0; i < CRASH_TIMINGS; i++) { crashLog.timings[i].task = CRASH_IDLE; }
+}
+
+////////// SCHEDULER HOOKS ///////////
+void crash_tick_begin(void) {
+    crashLog.ticks++;
+    crashLog.inTick = 1;
+}
+
+void crash_tick_end(void) {
+    crashLog.inTick = 0;
+}
+
+/* Called before each TickFct, startCounts being how far into the tick it is called. */
+void crash_task_begin(unsigned char task, signed char state, unsigned short startCounts) {
+    crashLog.state = state;
+    crashLog.taskStartCounts = startCounts;
+    crashLog.task = task;
+}
+
+/* 1 if the record shows a tick that never finished. */
+unsigned char crash_pending(void) {
+    return crashLog.magic == CRASH_MAGIC && (crashLog.inTick || crashLog.task != CRASH_IDLE);
+}
+
+/* Called when the TickFct returns, with its run time in clock counts. */
+void crash_task_end(unsigned short counts) {
+    taskTiming *t = &crashLog.timings[crashLog.next];
+    t->task = crashLog.task;
+    t->counts = counts;
+    crashLog.next = (crashLog.next + 1) % CRASH_TIMINGS;
+    crashLog.task = CRASH_IDLE;
+}
+
+#endif /* CRASHLOG_H */
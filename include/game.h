@@ -0,0 +1,976 @@
+#ifndef GAME_H
+#define GAME_H
+#include <avr/pgmspace.h>
+
+// Tick timing (longest tick, overruns, achieved rate, shed counts) reads the
+// clock and does 32-bit math in the ISR, so only -DTICK_STATS builds keep it.
+// HIGH_REFRESH needs it for its frame budget.
+#if defined(HIGH_REFRESH) && !defined(TICK_STATS)
+#define TICK_STATS
+#endif
+
+#include "coroutine.h"
+#include "snapshot.h"
+#include "collision.h"
+#include "sprites.h"
+#include "crashlog.h"
+#ifdef HUD
+#include "hud.h"
+#endif
+
+// Task struct for concurrent synchSMs implmentations
+typedef struct _task{
+    signed char state; //Task's current state
+    unsigned short period; //Task period
+    unsigned short elapsedTime; //Time elapsed since last task tick
+    int (*TickFct)(int); //Task tick function
+} task;
+
+// Text display messages, kept in flash
+const char P1_WINS_MSG[] PROGMEM = "P1 WINS!";
+const char P2_WINS_MSG[] PROGMEM = "P2 WINS!";
+const char DESYNC_MSG[] PROGMEM = "DESYNC";
+
+// Game flags, packed into two bytes. Setting a field is a read-modify-write
+// of the byte it shares, which is safe because only the tasks write them, all
+// inside TimerISR(). Code outside the ISR reads the published snapshot.
+typedef struct _gameFlags {
+    unsigned char gameStatus : 1;
+    unsigned char startReset : 1;
+    unsigned char numPlayers : 2; // can be 1 or 2 players
+    unsigned char newRally : 2; // tells ball task to reset ball to middle
+    unsigned char pointScored : 2; // 1 for point scored by player 1, 2 for point scored by player 2
+    unsigned char winner : 2; // 1 if player 1 wins, 2 if player 2 wins
+} gameFlags;
+
+// Ball coroutine context
+typedef struct _ballCo {
+    coroutine co;
+    unsigned short i; // flash sequence counter
+} ballCo;
+
+/* The game core: shared state, the task state machines and their helpers.
+   Display draws the playfield (fill, glyph, blit) and the text display (text*), Input reads the
+   paddles and buttons, Clock times each scheduler tick. Everything is static and
+   the backends are static inline functions, so an instantiation compiles to the
+   same code as plain globals and direct calls. See backends.h for the AVR ones. */
+template <class Display, class Input, class Clock>
+class Game {
+public:
+    static const unsigned char NUM_TASKS = 8;
+
+    // Game constants
+    static const char PADDLE_WIDTH = 26;
+    static const char PADDLE_DEPTH = 5;
+    static const char BALL_DIAMETER = 4;
+    static const short BACKGROUND_COLOR = (0x0000);
+    static const short OBJECT_COLOR = (0xFFFF);
+    static const short GOLD_COLOR = (0xaae0);
+    static const short BROWN_COLOR = (0x1860);
+    static const char POINTS_TO_WIN = 3;
+    static const signed char BALL_MAX_DY = 3; // fastest vertical ball speed, px per step
+    static const unsigned char TITLE_X = 41; // title sprite position, above the waiting ball
+    static const unsigned char TITLE_Y = 12;
+
+    // Ball y velocity change by where it hits a paddle, see collision.h
+    typedef deflectTable<PADDLE_WIDTH, BALL_DIAMETER, PADDLE_ZONES> Deflect;
+
+    // Shared variables
+    static unsigned char player1Loc[4]; // in order: xs, xe, ys, ye
+    static unsigned char player2Loc[4];
+    static unsigned char ballLoc[4]; // in order: xs, xe, ys, ye
+    static signed char ballVec[2]; // in order:x, y
+    static unsigned char player1Score;
+    static unsigned char player2Score;
+    static gameFlags flags;
+
+    // Task periods and GCD
+#ifdef HIGH_REFRESH
+    static const unsigned long GCD_PERIOD = 10; // 100 Hz ball and paddles
+#else
+    static const unsigned long GCD_PERIOD = 25;
+#endif
+    static const unsigned long GAME_MANAGER_PERIOD = 500;
+    static const unsigned long START_RESET_PERIOD = 200;
+    static const unsigned long PLAYER_TOGGLE_BUTTON_PERIOD = 200;
+    static const unsigned long PLAYER1_PERIOD = GCD_PERIOD;
+    static const unsigned long PLAYER2_PERIOD = GCD_PERIOD;
+    static const unsigned long BALL_PERIOD = GCD_PERIOD;
+    static const unsigned long INFO_DISPLAY_PERIOD = 1000;
+    static const unsigned long SCREEN_FILL_PERIOD = GCD_PERIOD;
+    static const unsigned long HUD_PERIOD = GCD_PERIOD;
+
+    // Game speed: the ball steps by ballVec, and the computer's paddle by 2 px,
+    // once per STEP_PERIOD of game time. HIGH_REFRESH ticks more often than that
+    // and draws the ball between its steps, so only the update rate changes.
+    static const unsigned long STEP_PERIOD = 25;
+#ifdef HIGH_REFRESH
+    static unsigned char stepPhase; // game time since the last step, ms
+    static unsigned char stepDue; // 1 when this tick is a step
+    static unsigned char ballFrom[2]; // ball x, y before its last step
+    static unsigned char ballShown[2]; // ball x, y where it is drawn
+    static unsigned char player2Shown; // computer's paddle top edge where it is drawn
+    static unsigned char player2DrawDue; // 1 while its last step waits to be drawn
+#endif
+
+    // Ball flashing before a rally, in ball ticks
+    static const unsigned short BALL_FLASH_TICKS = 3000 / BALL_PERIOD;
+    static const unsigned short BALL_BLINK_TICKS = 500 / BALL_PERIOD;
+
+#ifdef HUD
+    // HUD layout: scores and player mode in the strips outside the ball's reach,
+    // the winner message under the medals
+    static const unsigned char HUD_P1_X = 1;
+    static const unsigned char HUD_P2_X = 125;
+    static const unsigned char HUD_SCORE_Y = 2;
+    static const unsigned char HUD_MODE_Y = 115;
+    static const unsigned char HUD_MSG_X = 32;
+    static const unsigned char HUD_MSG_Y = 96;
+    static const unsigned char HUD_MSG_SCALE = 2;
+
+    static unsigned char hudShown[4]; // values on screen, in order: player1Score, player2Score, numPlayers, message
+#endif
+
+    static task tasks[NUM_TASKS]; // task array
+    static const unsigned char INFO_TASK = 6; // index of the info display (or HUD) task
+
+    // Frame budget governor, HIGH_REFRESH builds only. Low priority work is shed
+    // (deferred or skipped) when its last measured cost would push the tick past
+    // FRAME_BUDGET_US. Work that costs more than the whole budget is never shed,
+    // since waiting for an emptier tick would not make it fit.
+    enum ShedWork { SHED_INFO, SHED_MEDAL, SHED_AI, SHED_KINDS };
+    static const unsigned long FRAME_BUDGET_US = GCD_PERIOD * 1000 - 1000; // 1 ms margin for the rest of the ISR
+    static const unsigned char SHED_MAX_SKIPS = 4; // work shed this many times in a row runs anyway
+    static const unsigned char SHED_AI_MAX_SKIPS = 1; // the computer's paddle is drawn before its next step
+#ifdef HIGH_REFRESH
+    static unsigned int workCostUs[SHED_KINDS]; // last measured cost of each kind of work
+    static unsigned char workSkips[SHED_KINDS]; // times shed in a row
+#endif
+
+#ifdef TICK_STATS
+    // Tick timing and shedding statistics, times in microseconds
+    static unsigned int tickStart; // Clock count at the start of the current tick
+    static unsigned long lastTickUs;
+    static unsigned long maxTickUs;
+    static unsigned short overruns; // ticks that took longer than GCD_PERIOD
+    static unsigned short shedCount[SHED_KINDS]; // times shed in total
+
+    // Achieved tick rate, measured over windows of about a second
+    static unsigned int lastTickStart;
+    static unsigned long rateUs;
+    static unsigned short rateTicks;
+    static unsigned char frameHz;
+    static unsigned char rateWindows; // completed windows
+#endif
+
+    // Coroutine contexts
+    static ballCo ball;
+    static blockFill screenFill; // chunked screen clear requested by the game manager
+
+    // Consistent copy of the shared variables, published at the end of every tick.
+    // Code outside TimerISR() reads it with snapshot_read().
+    static snapshotBuffer published;
+
+    // Task states
+    enum GameManager { GM_INIT, GM_PLAY, GM_WIN, GM_TITLE };
+    enum StartReset { SR_RESET, SR_PRESS_START, SR_START, SR_PRESS_RESET };
+    enum PlayerToggleButton { PT_TWO, PT_PRESS_ONE, PT_ONE, PT_PRESS_TWO };
+    enum Player1 { P1_INIT, P1_MOVE };
+    enum Player2 { P2_INIT, P2_MOVE, P2_AUTO };
+    enum InfoDisplay { ID_INIT };
+
+    /* Runs every task that is due. Call once per GCD_PERIOD. */
+    static void tick() {
+        unsigned int start = Clock::now();
+#ifdef TICK_STATS
+        tickStart = start;
+        measureRate(start);
+#endif
+        crash_tick_begin();
+#ifdef HIGH_REFRESH
+        stepPhase += GCD_PERIOD;
+        stepDue = stepPhase >= STEP_PERIOD;
+        if (stepDue) { stepPhase -= STEP_PERIOD; }
+#endif
+        for ( unsigned int i = 0; i < NUM_TASKS; i++ ) { // Iterate through each task in the task array
+            if ( tasks[i].elapsedTime >= tasks[i].period ) { // Check if the task is ready to tick
+                if ( i == INFO_TASK && !budgetAllows(SHED_INFO) ) { continue; } // deferred, still due next tick
+                unsigned int taskStart = Clock::now();
+                crash_task_begin(i, tasks[i].state, taskStart - start);
+                tasks[i].state = tasks[i].TickFct(tasks[i].state); // Tick and set the next state for this task
+                crash_task_end(Clock::now() - taskStart);
+                if ( i == INFO_TASK ) { budgetSpent(SHED_INFO, taskStart); }
+                tasks[i].elapsedTime = 0; // Reset the elapsed time for the next tick
+            }
+            tasks[i].elapsedTime += GCD_PERIOD; // Increment the elapsed time by GCD_PERIOD
+        }
+        publish();
+#ifdef TICK_STATS
+        lastTickUs = (unsigned long)(unsigned int)(Clock::now() - start) * Clock::US_PER_COUNT;
+        if (lastTickUs > maxTickUs) { maxTickUs = lastTickUs; }
+        if (lastTickUs > GCD_PERIOD * 1000) { overruns++; }
+#endif
+        crash_tick_end();
+    }
+
+    /* Returns 1 if work of this kind still fits in the current tick. Otherwise
+       counts it as shed and returns 0. Always 1 outside HIGH_REFRESH builds. */
+    static unsigned char budgetAllows(unsigned char kind) {
+#ifdef HIGH_REFRESH
+        unsigned long used = (unsigned long)(unsigned int)(Clock::now() - tickStart) * Clock::US_PER_COUNT;
+        unsigned char maxSkips = kind == SHED_AI ? SHED_AI_MAX_SKIPS : SHED_MAX_SKIPS;
+        if (used + workCostUs[kind] <= FRAME_BUDGET_US || workCostUs[kind] > FRAME_BUDGET_US ||
+            workSkips[kind] >= maxSkips) {
+            workSkips[kind] = 0;
+            return 1;
+        }
+        workSkips[kind]++;
+        shedCount[kind]++;
+        return 0;
+#else
+        (void)kind;
+        return 1;
+#endif
+    }
+
+    /* Records the cost of work of this kind that began at Clock count since.
+       Nothing outside HIGH_REFRESH builds. */
+    static void budgetSpent(unsigned char kind, unsigned int since) {
+#ifdef HIGH_REFRESH
+        unsigned long cost = (unsigned long)(unsigned int)(Clock::now() - since) * Clock::US_PER_COUNT;
+        workCostUs[kind] = cost > 0xFFFF ? 0xFFFF : cost;
+#else
+        (void)kind;
+        (void)since;
+#endif
+    }
+
+#ifdef TICK_STATS
+    /* Adds the time since the previous tick to the rate window, and updates frameHz
+       once the window reaches a second. */
+    static void measureRate(unsigned int start) {
+        rateUs += (unsigned long)(unsigned int)(start - lastTickStart) * Clock::US_PER_COUNT;
+        lastTickStart = start;
+        rateTicks++;
+        if (rateUs >= 1000000UL) {
+            frameHz = (rateTicks * 1000000UL + rateUs / 2) / rateUs;
+            rateTicks = 0;
+            rateUs = 0;
+            rateWindows++;
+        }
+    }
+#endif
+
+    /* Copies the shared variables into published as one consistent frame. */
+    static void publish() {
+        gameSnapshot *s = &published.data;
+        snapshot_begin(&published);
+        for (unsigned char i = 0; i < 4; i++) {
+            s->ballLoc[i] = ballLoc[i];
+            s->player1Loc[i] = player1Loc[i];
+            s->player2Loc[i] = player2Loc[i];
+        }
+        s->ballVec[0] = ballVec[0];
+        s->ballVec[1] = ballVec[1];
+        s->pointScored = flags.pointScored;
+        s->newRally = flags.newRally;
+        s->player1Score = player1Score;
+        s->player2Score = player2Score;
+        s->numPlayers = flags.numPlayers;
+        s->winner = flags.winner;
+        s->gameStatus = flags.gameStatus;
+#ifdef TICK_STATS
+        s->frameHz = frameHz;
+        s->rateWindows = rateWindows;
+        s->overruns = overruns;
+        for (unsigned char i = 0; i < SHED_KINDS; i++) { s->shedCount[i] = shedCount[i]; }
+#endif
+        snapshot_end(&published);
+    }
+
+    /* Fills the task array with every game task in its initial state. */
+    static void initTasks() {
+        unsigned char i = 0;
+
+        Clock::start();
+#ifdef TICK_STATS
+        lastTickStart = Clock::now();
+#endif
+
+        // initialize tasks
+        tasks[i].state = GM_INIT; // the board is already clear from boot, so no clearBoard()
+        tasks[i].period = GAME_MANAGER_PERIOD;
+        tasks[i].elapsedTime = tasks[i].period;
+        tasks[i].TickFct = &Tick_Game_Manager;
+        i++;
+        tasks[i].state = SR_RESET;
+        tasks[i].period = START_RESET_PERIOD;
+        tasks[i].elapsedTime = tasks[i].period;
+        tasks[i].TickFct = &Tick_Start_Reset;
+        i++;
+        tasks[i].state = PT_TWO;
+        tasks[i].period = PLAYER_TOGGLE_BUTTON_PERIOD;
+        tasks[i].elapsedTime = tasks[i].period;
+        tasks[i].TickFct = &Tick_Player_Toggle;
+        i++;
+        tasks[i].state = P1_INIT;
+        tasks[i].period = PLAYER1_PERIOD;
+        tasks[i].elapsedTime = tasks[i].period;
+        tasks[i].TickFct = &Tick_Player1;
+        i++;
+        tasks[i].state = P2_INIT;
+        tasks[i].period = PLAYER2_PERIOD;
+        tasks[i].elapsedTime = tasks[i].period;
+        tasks[i].TickFct = &Tick_Player2;
+        i++;
+        tasks[i].state = 0; // coroutine task, progress is kept in ball
+        tasks[i].period = BALL_PERIOD;
+        tasks[i].elapsedTime = tasks[i].period;
+        tasks[i].TickFct = &Tick_Ball;
+        i++;
+#ifdef HUD
+        tasks[i].state = 0;
+        tasks[i].period = HUD_PERIOD;
+        tasks[i].elapsedTime = tasks[i].period;
+        tasks[i].TickFct = &Tick_Hud;
+        hudInvalidate();
+#else
+        tasks[i].state = ID_INIT;
+        tasks[i].period = INFO_DISPLAY_PERIOD;
+        tasks[i].elapsedTime = tasks[i].period;
+        tasks[i].TickFct = &Tick_Info_Display;
+#endif
+        i++;
+        tasks[i].state = 0; // coroutine task, progress is kept in screenFill
+        tasks[i].period = SCREEN_FILL_PERIOD;
+        tasks[i].elapsedTime = tasks[i].period;
+        tasks[i].TickFct = &Tick_Screen_Fill;
+        i++;
+    }
+
+    // Task function definitions
+
+    static int Tick_Game_Manager(int state) {
+        switch (state) { // Transitions
+            case GM_INIT:
+                if (flags.startReset) {
+                    flags.startReset = 0;
+                    flags.gameStatus = 1;
+                    state = GM_PLAY;    
+                }
+                else if (!screenFill.active) {
+                    state = GM_TITLE;
+                    Display::blit(TITLE_X, TITLE_Y, &titleSprite, 0); // on the cleared screen
+                }
+                break;
+            case GM_TITLE:
+                if (flags.startReset) {
+                    flags.startReset = 0;
+                    flags.gameStatus = 1;
+                    fillStart(&screenFill, TITLE_X, TITLE_X + pgm_read_byte(&titleSprite.width) - 1,
+                              TITLE_Y, TITLE_Y + pgm_read_byte(&titleSprite.height) - 1, BACKGROUND_COLOR); // clear the title
+                    state = GM_PLAY;
+                }
+                break;
+            case GM_PLAY:
+                if (flags.startReset) {
+                    flags.startReset = 0;
+                    flags.gameStatus = 0;
+                    state = GM_INIT;
+                    clearBoard();
+                }
+                if (flags.winner) {
+                    state = GM_WIN;
+                    flags.gameStatus = 0;
+                }
+                break;
+            case GM_WIN:
+                if (flags.startReset) {
+                    flags.startReset = 0;
+                    state = GM_INIT;
+                    clearBoard();
+                }
+                break;
+            default:
+                state = GM_INIT;
+                clearBoard();
+                break;
+        }
+        switch (state) { // Actions
+            case GM_INIT:
+                // reset the scores; the board is cleared once, on entering GM_INIT
+                player1Score = 0;
+                player2Score = 0;
+                flags.winner = 0;
+                break;
+            case GM_PLAY:
+                // track scores and detect when there is a winner
+                 if (flags.pointScored == 1) {
+                    flags.pointScored = 0;
+                    player1Score++;
+                    if (player1Score >= POINTS_TO_WIN) { flags.winner = 1; }
+                } else if (flags.pointScored == 2) {
+                    flags.pointScored = 0;
+                    player2Score++;
+                    if (player2Score >= POINTS_TO_WIN) { flags.winner = 2; }
+                } else {}
+                break;
+            case GM_WIN:
+                // display a gold medal on the winner's side and a bronze one on the loser's side
+                if (budgetAllows(SHED_MEDAL)) {
+                    unsigned int since = Clock::now();
+                    if (flags.winner == 1) {
+                        Display::blit(80, 50, &medalSprite, bronzePalette);
+                        Display::blit(20, 50, &medalSprite, 0);
+                    } else if (flags.winner == 2) {
+                        Display::blit(80, 50, &medalSprite, 0);
+                        Display::blit(20, 50, &medalSprite, bronzePalette);
+                    } else {}
+                    budgetSpent(SHED_MEDAL, since);
+                }
+                break;
+            default:
+                break;
+        }
+        return state;
+    }
+
+    static int Tick_Start_Reset(int state) {
+        switch(state) { // Transitions
+            case SR_RESET:
+                if (Input::startButton()) {
+                    state = SR_PRESS_START;
+                }
+                break;
+            case SR_PRESS_START:
+                if (!Input::startButton()) {
+                    state = SR_START;
+                    flags.startReset = 1;
+                }
+                break;
+            case SR_START:
+                if (Input::startButton()) {
+                    state = SR_PRESS_RESET;
+                }
+                break;
+            case SR_PRESS_RESET:
+                if (!Input::startButton()) {
+                    state = SR_RESET;
+                    flags.startReset = 1;
+                }
+                break;
+            default:
+                break;
+        }
+        return state;
+    }
+
+    static int Tick_Player_Toggle(int state) {
+        switch(state) { // Transitions
+            case PT_TWO:
+                if (!flags.gameStatus && Input::toggleButton()) {
+                    state = PT_PRESS_ONE;
+                }
+                break;
+            case PT_PRESS_ONE:
+                if (!flags.gameStatus && !Input::toggleButton()) {
+                    state = PT_ONE;
+                    flags.numPlayers = 1;
+                }
+                break;
+            case PT_ONE:
+                if (!flags.gameStatus && Input::toggleButton()) {
+                    state = PT_PRESS_TWO;
+                }
+                break;
+            case PT_PRESS_TWO:
+                if (!flags.gameStatus && !Input::toggleButton()) {
+                    state = PT_TWO;
+                    flags.numPlayers = 2;
+                }
+                break;
+            default:
+                state = PT_TWO;
+                break;
+        }
+        return state;
+    }
+
+    static int Tick_Player1(int state) {
+        static unsigned char newLoc;
+        switch (state) { // Transitions
+            case P1_INIT:
+                if (flags.gameStatus) {
+                    state = P1_MOVE;
+                } 
+                break;
+            case P1_MOVE:
+                if (!flags.gameStatus) {
+                    state = P1_INIT;
+                    Display::fill(player1Loc[0], player1Loc[1], player1Loc[2], player1Loc[3], BACKGROUND_COLOR); // clear paddle
+                }
+                break;
+            default:
+                state = P1_INIT;
+                break;
+        }
+        switch (state) { // Actions
+            case P1_INIT:
+                // Display::fill(player1Loc[0], player1Loc[1], player1Loc[2], player1Loc[3], BACKGROUND_COLOR); // clear paddle
+                break;
+            case P1_MOVE:
+                Display::fill(player1Loc[0], player1Loc[1], player1Loc[2], player1Loc[3], BACKGROUND_COLOR); // clear previous paddle
+                newLoc = Input::paddle(1); // get new paddle location
+                player1Loc[0] = 10;
+                player1Loc[1] = 10 + PADDLE_DEPTH;
+                player1Loc[2] = newLoc; // update location info
+                player1Loc[3] = newLoc + PADDLE_WIDTH;
+                Display::fill(player1Loc[0], player1Loc[1], player1Loc[2], player1Loc[3], OBJECT_COLOR); // display paddle at new location
+                break;
+            default:
+                break;
+        }   
+        return state;
+    }
+
+    static int Tick_Player2(int state) {
+        static unsigned char newLoc;
+        switch (state) { // Transitions
+            case P2_INIT:
+                if (flags.gameStatus) {
+                    if (flags.numPlayers == 2) {
+                        state = P2_MOVE;
+                    }
+                    else {
+                        state = P2_AUTO;
+#ifdef HIGH_REFRESH
+                        player2Shown = player2Loc[2];
+                        player2DrawDue = 0;
+#endif
+                    }
+                }
+                break;
+            case P2_MOVE:
+                if (!flags.gameStatus) {
+                    state = P2_INIT;
+                }
+                break;
+            case P2_AUTO:
+                if (!flags.gameStatus) {
+                    state = P2_INIT;
+#ifdef HIGH_REFRESH
+                    if (player2Shown != player2Loc[2]) { // last step never drawn: clear where the paddle is shown
+                        Display::fill(player2Loc[0], player2Loc[1], player2Shown, player2Shown + PADDLE_WIDTH, BACKGROUND_COLOR);
+                    }
+#endif
+                }
+                break;
+            default:
+                state = P2_INIT;
+                break;
+        }
+        switch (state) { // Actions
+            case P2_INIT:
+                Display::fill(player2Loc[0], player2Loc[1], player2Loc[2], player2Loc[3], BACKGROUND_COLOR); // clear paddle
+                break;
+            case P2_MOVE:
+                Display::fill(player2Loc[0], player2Loc[1], player2Loc[2], player2Loc[3], BACKGROUND_COLOR); // clear previous paddle
+                newLoc = Input::paddle(2); // get new paddle location
+                player2Loc[0] = 119 - PADDLE_DEPTH;
+                player2Loc[1] = 119;
+                player2Loc[2] = newLoc; // update location info
+                player2Loc[3] = newLoc + PADDLE_WIDTH;
+                Display::fill(player2Loc[0], player2Loc[1], player2Loc[2], player2Loc[3], OBJECT_COLOR); // display paddle at new location
+                break;
+            case P2_AUTO:
+#ifdef HIGH_REFRESH
+                // The paddle steps with the game, so shedding never changes play.
+                // Only drawing it is deferred, by at most SHED_AI_MAX_SKIPS ticks.
+                if (stepDue) {
+                    stepPlayer2();
+                    player2DrawDue = 1;
+                }
+                if (player2DrawDue && budgetAllows(SHED_AI)) {
+                    unsigned int since = Clock::now();
+                    Display::fill(player2Loc[0], player2Loc[1], player2Shown, player2Shown + PADDLE_WIDTH, BACKGROUND_COLOR); // clear previous paddle
+                    Display::fill(player2Loc[0], player2Loc[1], player2Loc[2], player2Loc[3], OBJECT_COLOR); // display new paddle
+                    player2Shown = player2Loc[2];
+                    player2DrawDue = 0;
+                    budgetSpent(SHED_AI, since);
+                }
+#else
+                autonomousPlayer2();
+#endif
+            default:
+                break;
+        }   
+        return state;
+    }
+
+    /* Ball sequence: wait for a game, flash the ball, then move it until a point is
+       scored (flash again) or the game ends (back to the start). */
+    static char Co_Ball(ballCo *b) {
+        CO_BEGIN(&b->co);
+        for (;;) {
+            while (!flags.gameStatus) {
+                Display::blit(ballLoc[0], ballLoc[2], &ballSprite, 0);
+                CO_YIELD(&b->co);
+            }
+            while (flags.gameStatus) {
+                for (b->i = 0; b->i <= BALL_FLASH_TICKS; b->i++) {
+                    if ((b->i / BALL_BLINK_TICKS) % 2 == 0) {
+                        Display::blit(ballLoc[0], ballLoc[2], &ballSprite, 0);
+                    }
+                    else {
+                        Display::fill(ballLoc[0], ballLoc[1], ballLoc[2], ballLoc[3], BACKGROUND_COLOR);
+                    }
+                    CO_YIELD(&b->co);
+                }
+#ifdef HIGH_REFRESH
+                ballFrom[0] = ballShown[0] = ballLoc[0];
+                ballFrom[1] = ballShown[1] = ballLoc[2];
+#endif
+                do {
+#ifdef HIGH_REFRESH
+                    moveBallSmooth();
+#else
+                    flags.pointScored = checkCollision();
+                    flags.newRally = flags.pointScored;
+                    moveBall();
+#endif
+                    CO_YIELD(&b->co);
+                } while (flags.gameStatus && !flags.newRally);
+                if (flags.gameStatus) {
+                    flags.newRally = 0;
+                    Display::fill(ballLoc[0], ballLoc[1], ballLoc[2], ballLoc[3], BACKGROUND_COLOR);
+                }
+            }
+            // ball to default settings
+            ballVec[0] = 2;
+            ballVec[1] = 2;
+            ballLoc[0] = 62;
+            ballLoc[1] = 62 + BALL_DIAMETER;
+            ballLoc[2] = 62;
+            ballLoc[3] = 62 + BALL_DIAMETER;
+            Display::fill(ballLoc[0], ballLoc[1], ballLoc[2], ballLoc[3], BACKGROUND_COLOR);
+        }
+        CO_END(&b->co);
+    }
+
+    static int Tick_Ball(int state) {
+        Co_Ball(&ball);
+        return state;
+    }
+
+    static int Tick_Screen_Fill(int state) {
+#ifdef HUD
+        if (screenFill.active && Co_Fill<Display>(&screenFill) == CO_DONE) { hudInvalidate(); } // the clear wiped the HUD
+#else
+        Co_Fill<Display>(&screenFill);
+#endif
+        return state;
+    }
+
+#ifdef HUD
+    /* Redraws the HUD items whose values changed since they were last drawn. */
+    static int Tick_Hud(int state) {
+        unsigned char message = Input::linkError() ? 3 : flags.winner;
+
+        if (player1Score != hudShown[0]) {
+            hudShown[0] = player1Score;
+            hud_num_v<Display>(HUD_P1_X, HUD_SCORE_Y, player1Score, OBJECT_COLOR, BACKGROUND_COLOR);
+        }
+        if (player2Score != hudShown[1]) {
+            hudShown[1] = player2Score;
+            hud_num_v<Display>(HUD_P2_X, HUD_SCORE_Y, player2Score, OBJECT_COLOR, BACKGROUND_COLOR);
+        }
+        if (flags.numPlayers != hudShown[2]) {
+            hudShown[2] = flags.numPlayers;
+            Display::glyph(HUD_P1_X, HUD_MODE_Y, hud_glyph(flags.numPlayers + '0'), HUD_GLYPH_W, HUD_GLYPH_H, 1, OBJECT_COLOR, BACKGROUND_COLOR);
+            Display::glyph(HUD_P1_X, HUD_MODE_Y + HUD_GLYPH_H + 1, hud_glyph('P'), HUD_GLYPH_W, HUD_GLYPH_H, 1, OBJECT_COLOR, BACKGROUND_COLOR);
+        }
+        if (message != hudShown[3]) {
+            hudShown[3] = message;
+            // messages differ in length: clear the whole line first
+            Display::fill(HUD_MSG_X, HUD_MSG_X + 8 * (HUD_GLYPH_W + 1) * HUD_MSG_SCALE - 1,
+                          HUD_MSG_Y, HUD_MSG_Y + HUD_GLYPH_H * HUD_MSG_SCALE - 1, BACKGROUND_COLOR);
+            if (message == 1) { hud_str_P<Display>(HUD_MSG_X, HUD_MSG_Y, P1_WINS_MSG, HUD_MSG_SCALE, GOLD_COLOR, BACKGROUND_COLOR); }
+            else if (message == 2) { hud_str_P<Display>(HUD_MSG_X, HUD_MSG_Y, P2_WINS_MSG, HUD_MSG_SCALE, GOLD_COLOR, BACKGROUND_COLOR); }
+            else if (message == 3) { hud_str_P<Display>(HUD_MSG_X, HUD_MSG_Y, DESYNC_MSG, HUD_MSG_SCALE, OBJECT_COLOR, BACKGROUND_COLOR); }
+            else {}
+        }
+        return state;
+    }
+
+    /* Marks every HUD item as not on screen, so the next Tick_Hud redraws it. */
+    static void hudInvalidate(void) {
+        for (unsigned char i = 0; i < 4; i++) { hudShown[i] = 0xFF; }
+    }
+#endif
+
+    static int Tick_Info_Display(int state) {
+        Display::textClear();
+
+        // display winner
+        Display::textGoto(0, 4);
+        if(flags.winner == 1) { Display::textStrP(P1_WINS_MSG); }
+        else if (flags.winner == 2) { Display::textStrP(P2_WINS_MSG); }
+        else {}
+        if (Input::linkError()) { Display::textGoto(0, 4); Display::textStrP(DESYNC_MSG); }
+
+        // display player mode
+        Display::textGoto(1, 7);
+        Display::textChar(flags.numPlayers + 48);
+        Display::textChar('P');
+
+        // display P2 score
+        Display::textGoto(1, 0);
+        if (player1Score < 10) {
+            Display::textChar('0');
+            Display::textGoto(1, 1);
+            Display::textChar(player2Score + 0x30);
+        }
+        else {
+            Display::textChar(player2Score / 10 + 0x30);
+            Display::textGoto(1, 1);
+            Display::textChar(player2Score % 10 + 0x30);
+        }
+
+        // display P1 score
+        Display::textGoto(1, 14);
+        if (player1Score < 10) {
+            Display::textChar('0');
+            Display::textGoto(1, 15);
+            Display::textChar(player1Score + 0x30);
+        }
+        else {
+            Display::textChar(player1Score / 10 + 0x30);
+            Display::textGoto(1, 15);
+            Display::textChar(player1Score % 10 + 0x30);
+        }
+
+        return 0;
+    }
+
+    // Helper functions
+
+    /* Starts the chunked clear of the whole board. Called once when the Game
+       Manager enters GM_INIT, which waits in that state until the clear is done. */
+    static void clearBoard(void) {
+        fillStart(&screenFill, 0, 129, 0, 129, BACKGROUND_COLOR);
+    }
+
+    /* Moves the ball according to ballVec*/
+    static void moveBall(void) {
+        Display::fill(ballLoc[0], ballLoc[1], ballLoc[2], ballLoc[3], BACKGROUND_COLOR); // clear previous ball
+        stepBall();
+        Display::blit(ballLoc[0], ballLoc[2], &ballSprite, 0); // display ball at new location
+    }
+
+#ifdef HIGH_REFRESH
+    /* One ball tick at HIGH_REFRESH. The ball collides and steps only when
+       stepDue; every tick it is drawn stepPhase of the way from where it was
+       before the last step to where it is now. So the drawn ball trails ballLoc,
+       which collisions use, by up to one step (ballVec px): it is drawn reaching
+       a paddle or wall up to 25 ms after the bounce was decided. Colliding at
+       the drawn position instead would change play from the 25 ms build. */
+    static void moveBallSmooth(void) {
+        Display::fill(ballShown[0], ballShown[0] + BALL_DIAMETER, ballShown[1], ballShown[1] + BALL_DIAMETER, BACKGROUND_COLOR); // clear previous ball
+        if (stepDue) {
+            flags.pointScored = checkCollision();
+            flags.newRally = flags.pointScored;
+            ballFrom[0] = ballLoc[0];
+            ballFrom[1] = ballLoc[2];
+            stepBall();
+            if (flags.newRally) { return; } // back in the middle, shown again by the flashing
+        }
+        ballShown[0] = ballFrom[0] + (ballLoc[0] - ballFrom[0]) * (int)stepPhase / (int)STEP_PERIOD;
+        ballShown[1] = ballFrom[1] + (ballLoc[2] - ballFrom[1]) * (int)stepPhase / (int)STEP_PERIOD;
+        Display::blit(ballShown[0], ballShown[1], &ballSprite, 0);
+    }
+#endif
+
+    /* Updates ballLoc by one step of ballVec, without drawing. */
+    static void stepBall(void) {
+        unsigned char newX;
+        unsigned char newY;
+
+        newX = ballLoc[0] + ballVec[0]; // get new ball xs
+        newY = ballLoc[2] + ballVec[1]; // get new ball ys
+
+        // keep ball within bounds of screen
+        if(newX <= 0) {newX = 0;}
+        if(newX >= 128) {newX = 128;}
+        if(newY <= 0) {newY = 0;}
+        if(newY >= 128) {newY = 128;}
+
+        // record new location of ball
+        ballLoc[0] = newX;
+        ballLoc[1] = newX + BALL_DIAMETER;
+        ballLoc[2] = newY;
+        ballLoc[3] = newY + BALL_DIAMETER;
+    }
+
+    /* Checks whether the ball has collided with the walls or paddles, and changes it's vector accordingly.
+       Returns 1 when player 1 scores, 2 when player 2 scores, and 0 when nobody scores. */
+    static int checkCollision(void) {
+
+        // side walls
+        if (ballLoc[2] <= 2 || ballLoc[3] >= 127) {
+            ballVec[1] *= -1;
+        }
+
+        // paddles, by the ball edge facing each one; one compare while the ball is between them
+        if ((unsigned char)(ballLoc[0] - player1Loc[1] - 1) > (unsigned char)(player2Loc[0] - player1Loc[1] - BALL_DIAMETER - 2)) {
+            paddleBounce(player1Loc, ballLoc[0]);
+            paddleBounce(player2Loc, ballLoc[1]);
+        }
+
+        // behind paddle 1
+        if (ballLoc[0] <= 6) {
+            Display::fill(ballLoc[0], ballLoc[1], ballLoc[2], ballLoc[3], BACKGROUND_COLOR); // clear previous ball
+            ballLoc[0] = 62;
+            ballLoc[1] = 62 + BALL_DIAMETER;
+            ballLoc[2] = 62;
+            ballLoc[3] = 62 + BALL_DIAMETER;
+            return 2; // player 2 gets a point
+        }
+
+        // behind paddle 2
+        if (ballLoc[1] >= 123) {
+            Display::fill(ballLoc[0], ballLoc[1], ballLoc[2], ballLoc[3], BACKGROUND_COLOR); // clear previous paddle
+            ballLoc[0] = 62;
+            ballLoc[1] = 62 + BALL_DIAMETER;
+            ballLoc[2] = 62;
+            ballLoc[3] = 62 + BALL_DIAMETER;
+            return 1; // player 1 gets a point
+        }
+
+        return 0; // no points awarded
+    }
+
+    /* Sends the ball back if ballX, its edge facing the paddle, is in the paddle's
+       column and the ball overlaps the paddle vertically. The y velocity changes by
+       the Deflect entry for where it hit. Costs one compare when the ball is
+       nowhere near the paddle. */
+    static void paddleBounce(const unsigned char *paddle, unsigned char ballX) {
+        if ((unsigned char)(ballX - paddle[0]) > (unsigned char)(paddle[1] - paddle[0])) { return; } // not in the column
+        unsigned char d = ballLoc[3] - paddle[2]; // wraps to a large value above the paddle
+        if (paddle[3] < paddle[2]) { // computer paddle wrapped past the top: only its last zone is tested
+            if (ballLoc[3] + 8 < paddle[3] || ballLoc[2] > paddle[3]) { return; }
+            d = Deflect::SIZE - 1;
+        }
+        else if (d >= Deflect::SIZE) { return; } // above or below the paddle
+        signed char vy = ballVec[1] + (signed char)pgm_read_byte(&Deflect::table[d]);
+        ballVec[0] = -ballVec[0];
+        ballVec[1] = vy > BALL_MAX_DY ? BALL_MAX_DY : (vy < -BALL_MAX_DY ? -BALL_MAX_DY : vy);
+    }
+
+    /* Moves paddle 2 autonomously towards the ball for 1 player games. */
+    static void autonomousPlayer2(void) {
+        Display::fill(player2Loc[0], player2Loc[1], player2Loc[2], player2Loc[3], BACKGROUND_COLOR);  // clear previous paddle
+        stepPlayer2();
+        Display::fill(player2Loc[0], player2Loc[1], player2Loc[2], player2Loc[3], OBJECT_COLOR); // display new paddle
+    }
+
+    /* Moves the computer's paddle 2 px toward the ball, without drawing. */
+    static void stepPlayer2(void) {
+        if (ballLoc[2] <= player2Loc[2]) {
+            player2Loc[2] -= 2;
+            player2Loc[3] -= 2;
+        }
+        else if (ballLoc[3] >= player2Loc[3]) {
+            player2Loc[2] += 2;
+            player2Loc[3] += 2;
+        }
+    }
+
+    /* Folds everything the simulation depends on into one byte, for desync detection. */
+    static unsigned char gameChecksum(void) {
+        unsigned char state[] = {
+            ballLoc[0], ballLoc[2], (unsigned char)ballVec[0], (unsigned char)ballVec[1],
+            player1Loc[2], player2Loc[2], player1Score, player2Score,
+            flags.gameStatus, flags.winner, flags.newRally, flags.pointScored
+        };
+        unsigned char sum = 0;
+        unsigned char check = 0;
+        for (unsigned char i = 0; i < sizeof(state); i++) {
+            sum += state[i];
+            check += sum;
+        }
+        return sum ^ (check << 1) ^ (check >> 7);
+    }
+
+};
+
+// Shared variable definitions
+template <class Display, class Input, class Clock>
+unsigned char Game<Display, Input, Clock>::player1Loc[4] = {10, 10 + PADDLE_DEPTH, 52, 52 + PADDLE_WIDTH};
+template <class Display, class Input, class Clock>
+unsigned char Game<Display, Input, Clock>::player2Loc[4] = {119 - PADDLE_DEPTH, 119, 52, 52 + PADDLE_WIDTH};
+template <class Display, class Input, class Clock>
+unsigned char Game<Display, Input, Clock>::ballLoc[4] = {62, 62 + BALL_DIAMETER, 62, 62 + BALL_DIAMETER};
+template <class Display, class Input, class Clock>
+signed char Game<Display, Input, Clock>::ballVec[2] = {2,2};
+template <class Display, class Input, class Clock>
+unsigned char Game<Display, Input, Clock>::player1Score = 0;
+template <class Display, class Input, class Clock>
+unsigned char Game<Display, Input, Clock>::player2Score = 0;
+template <class Display, class Input, class Clock>
+gameFlags Game<Display, Input, Clock>::flags = {0, 0, 2, 0, 0, 0};
+template <class Display, class Input, class Clock>
+task Game<Display, Input, Clock>::tasks[Game<Display, Input, Clock>::NUM_TASKS];
+template <class Display, class Input, class Clock>
+ballCo Game<Display, Input, Clock>::ball;
+template <class Display, class Input, class Clock>
+blockFill Game<Display, Input, Clock>::screenFill;
+template <class Display, class Input, class Clock>
+snapshotBuffer Game<Display, Input, Clock>::published;
+#ifdef HIGH_REFRESH
+template <class Display, class Input, class Clock>
+unsigned int Game<Display, Input, Clock>::workCostUs[Game<Display, Input, Clock>::SHED_KINDS];
+template <class Display, class Input, class Clock>
+unsigned char Game<Display, Input, Clock>::workSkips[Game<Display, Input, Clock>::SHED_KINDS];
+#endif
+#ifdef TICK_STATS
+template <class Display, class Input, class Clock>
+unsigned int Game<Display, Input, Clock>::tickStart;
+template <class Display, class Input, class Clock>
+unsigned long Game<Display, Input, Clock>::lastTickUs = 0;
+template <class Display, class Input, class Clock>
+unsigned long Game<Display, Input, Clock>::maxTickUs = 0;
+template <class Display, class Input, class Clock>
+unsigned short Game<Display, Input, Clock>::overruns = 0;
+template <class Display, class Input, class Clock>
+unsigned short Game<Display, Input, Clock>::shedCount[Game<Display, Input, Clock>::SHED_KINDS];
+template <class Display, class Input, class Clock>
+unsigned int Game<Display, Input, Clock>::lastTickStart;
+template <class Display, class Input, class Clock>
+unsigned long Game<Display, Input, Clock>::rateUs = 0;
+template <class Display, class Input, class Clock>
+unsigned short Game<Display, Input, Clock>::rateTicks = 0;
+template <class Display, class Input, class Clock>
+unsigned char Game<Display, Input, Clock>::frameHz = 0;
+template <class Display, class Input, class Clock>
+unsigned char Game<Display, Input, Clock>::rateWindows = 0;
+#endif
+#ifdef HUD
+template <class Display, class Input, class Clock>
+unsigned char Game<Display, Input, Clock>::hudShown[4];
+#endif
+#ifdef HIGH_REFRESH
+template <class Display, class Input, class Clock>
+unsigned char Game<Display, Input, Clock>::stepPhase = 0;
+template <class Display, class Input, class Clock>
+unsigned char Game<Display, Input, Clock>::stepDue = 0;
+template <class Display, class Input, class Clock>
+unsigned char Game<Display, Input, Clock>::ballFrom[2];
+template <class Display, class Input, class Clock>
+unsigned char Game<Display, Input, Clock>::ballShown[2];
+template <class Display, class Input, class Clock>
+unsigned char Game<Display, Input, Clock>::player2Shown;
+template <class Display, class Input, class Clock>
+unsigned char Game<Display, Input, Clock>::player2DrawDue = 0;
+#endif
+
+#endif /* GAME_H */
@@ -0,0 +1,66 @@
+#ifndef HUD_H
+#define HUD_H
+#include <avr/pgmspace.h>
+
+// Glyph atlas for drawing scores and messages on the ST7735 itself. Each glyph
+// is HUD_GLYPH_H rows of HUD_GLYPH_W bits, bit 2 being the leftmost pixel, and
+// is drawn through Display::glyph as one window.
+
+#define HUD_GLYPH_W 3
+#define HUD_GLYPH_H 5
+
+// digits 0-9, then the letters in HUD_LETTERS, then a blank
+const unsigned char hudFont[][HUD_GLYPH_H] PROGMEM = {
+    {0b111, 0b101, 0b101, 0b101, 0b111}, // 0
+    {0b010, 0b110, 0b010, 0b010, 0b111}, // 1
+    {0b111, 0b001, 0b111, 0b100, 0b111}, // 2
+    {0b111, 0b001, 0b011, 0b001, 0b111}, // 3
+    {0b101, 0b101, 0b111, 0b001, 0b001}, // 4
+    {0b111, 0b100, 0b111, 0b001, 0b111}, // 5
+    {0b111, 0b100, 0b111, 0b101, 0b111}, // 6
+    {0b111, 0b001, 0b010, 0b010, 0b010}, // 7
+    {0b111, 0b101, 0b111, 0b101, 0b111}, // 8
+    {0b111, 0b101, 0b111, 0b001, 0b111}, // 9
+    {0b110, 0b101, 0b110, 0b100, 0b100}, // P
+    {0b101, 0b101, 0b111, 0b111, 0b101}, // W
+    {0b111, 0b010, 0b010, 0b010, 0b111}, // I
+    {0b110, 0b101, 0b101, 0b101, 0b101}, // N
+    {0b011, 0b100, 0b010, 0b001, 0b110}, // S
+    {0b010, 0b010, 0b010, 0b000, 0b010}, // !
+    {0b110, 0b101, 0b101, 0b101, 0b110}, // D
+    {0b111, 0b100, 0b110, 0b100, 0b111}, // E
+    {0b101, 0b101, 0b010, 0b010, 0b010}, // Y
+    {0b011, 0b100, 0b100, 0b100, 0b011}, // C
+    {0b000, 0b000, 0b000, 0b000, 0b000}, // blank
+};
+
+const char HUD_LETTERS[] PROGMEM = "PWINS!DEYC";
+
+/* Returns the glyph rows (in PROGMEM) for c. Characters not in the atlas are blank. */
+const unsigned char *hud_glyph(char c) {
+    unsigned char i;
+    if (c >= '0' && c <= '9') { return hudFont[c - '0']; }
+    for (i = 0; pgm_read_byte(&HUD_LETTERS[i]); i++) {
+        if (pgm_read_byte(&HUD_LETTERS[i]) == c) { return hudFont[10 + i]; }
+    }
+    return hudFont[10 + sizeof(HUD_LETTERS) - 1];
+}
+
+/* Draws a PROGMEM string left to right, one glyph window per character. */
+template <class Display>
+void hud_str_P(unsigned char x, unsigned char y, const char *str, unsigned char scale, short fg, short bg) {
+    char c;
+    while ((c = pgm_read_byte(str++))) {
+        Display::glyph(x, y, hud_glyph(c), HUD_GLYPH_W, HUD_GLYPH_H, scale, fg, bg);
+        x += (HUD_GLYPH_W + 1) * scale;
+    }
+}
+
+/* Draws a two digit number top to bottom, for the narrow strips beside the paddles. */
+template <class Display>
+void hud_num_v(unsigned char x, unsigned char y, unsigned char num, short fg, short bg) {
+    Display::glyph(x, y, hud_glyph('0' + num / 10 % 10), HUD_GLYPH_W, HUD_GLYPH_H, 1, fg, bg);
+    Display::glyph(x, y + HUD_GLYPH_H + 1, hud_glyph('0' + num % 10), HUD_GLYPH_W, HUD_GLYPH_H, 1, fg, bg);
+}
+
+#endif /* HUD_H */
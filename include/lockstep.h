@@ -0,0 +1,156 @@
+#ifndef LOCKSTEP_H
+#define LOCKSTEP_H
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include "serialATMega.h"
+
+// Two-board lockstep link over the UART. Both boards run the same deterministic
+// game simulation; each tick the only thing exchanged is the local paddle
+// position and start button, one byte per tick:
+//
+//   0bpddddd  input for one tick: b = start button, p = tick parity,
+//             d = signed 5-bit change in paddle position (-16..15)
+//   1ccccccc  7-bit game state checksum after the last tick divisible by LOCKSTEP_CHECK_INTERVAL
+//
+// A paddle that moves further than the delta range in one tick is sent over the
+// next few ticks. Both boards simulate with the transmitted position, so the
+// simulations stay identical.
+//
+// The UART is polled, not interrupt driven, so nothing nests inside the timer
+// interrupt. Its receive buffer holds 3 bytes (2 in the FIFO, 1 in the shift
+// register), about 3 ms at LOCKSTEP_BAUD, and the other board sends at most 2
+// bytes per tick. That is enough for a HUD tick (about 11 ms at most), but not
+// for the LCD1602 info task, which blocks for over 100 ms.
+
+#ifndef HUD
+#error "LOCKSTEP polls the UART between ticks and needs the HUD build (-DHUD)"
+#endif
+
+#define LOCKSTEP_BAUD 9600
+#define LOCKSTEP_DELAY 3 // ticks between sampling a local input and simulating it
+#define LOCKSTEP_BUFFER 8 // input slots per side, must be more than 2 * LOCKSTEP_DELAY
+#define LOCKSTEP_CHECK_INTERVAL 16 // ticks between checksums
+#define LOCKSTEP_START_POS 52 // paddle top edge both boards assume before the first input
+#define LOCKSTEP_RX_SIZE 16 // must be a power of two
+
+unsigned char lsRole = 1; // which paddle this board drives, 1 or 2
+unsigned long lsTick = 0; // next tick to simulate
+unsigned long lsSent = 0; // next tick whose local input goes out
+unsigned long lsReceived = 0; // next tick whose remote input is expected
+unsigned char lsLocalPos = LOCKSTEP_START_POS; // last transmitted local position
+unsigned char lsRemotePos = LOCKSTEP_START_POS; // last received remote position
+unsigned char lsLocal[LOCKSTEP_BUFFER]; // bit 7: button, bits 6-0: paddle position
+unsigned char lsRemote[LOCKSTEP_BUFFER];
+unsigned char lsLocalCheck = 0; // bit 7 set while waiting to be compared
+unsigned char lsRemoteCheck = 0;
+unsigned char lsDesync = 0;
+
+// Inputs for the tick being simulated
+unsigned char lsPaddle[2] = {LOCKSTEP_START_POS, LOCKSTEP_START_POS};
+unsigned char lsButton = 0;
+
+// Received bytes not decoded yet. Filled by lockstep_receive(), emptied by
+// lockstep_poll(); both run with interrupts disabled.
+unsigned char lsRx[LOCKSTEP_RX_SIZE];
+unsigned char lsRxHead = 0;
+unsigned char lsRxTail = 0;
+
+/* Moves the bytes waiting in the UART into lsRx. Call with interrupts disabled:
+   from the main loop between ticks, and from lockstepTick() before and after
+   the game tick. */
+void lockstep_receive() {
+    while (serial_available()) {
+        if (UCSR0A & (1 << DOR0)) { lsDesync = 1; } // the UART dropped a byte before this one
+        unsigned char data = UDR0;
+        if ((unsigned char)(lsRxHead - lsRxTail) < LOCKSTEP_RX_SIZE) {
+            lsRx[lsRxHead & (LOCKSTEP_RX_SIZE - 1)] = data;
+            lsRxHead++;
+        } else {
+            lsDesync = 1; // overrun: an input was lost
+        }
+    }
+}
+
+/* Starts the link. The first LOCKSTEP_DELAY ticks use LOCKSTEP_START_POS on both boards. */
+void lockstep_init(unsigned char role) {
+    unsigned char i;
+    lsRole = role;
+    for (i = 0; i < LOCKSTEP_DELAY; i++) {
+        lsLocal[i] = LOCKSTEP_START_POS;
+        lsRemote[i] = LOCKSTEP_START_POS;
+    }
+    lsSent = LOCKSTEP_DELAY;
+    lsReceived = LOCKSTEP_DELAY;
+    serial_init(LOCKSTEP_BAUD);
+}
+
+/* Compares the two checksums of the same tick once both have arrived. */
+void lockstep_compare() {
+    if ((lsLocalCheck & 0x80) && (lsRemoteCheck & 0x80)) {
+        if (lsLocalCheck != lsRemoteCheck) { lsDesync = 1; }
+        lsLocalCheck = 0;
+        lsRemoteCheck = 0;
+    }
+}
+
+/* Decodes everything the other board has sent so far. */
+void lockstep_poll() {
+    lockstep_receive();
+    while (lsRxTail != lsRxHead) {
+        unsigned char data = lsRx[lsRxTail & (LOCKSTEP_RX_SIZE - 1)];
+        lsRxTail++;
+        if (data & 0x80) {
+            lsRemoteCheck = data;
+            lockstep_compare();
+            continue;
+        }
+        if (((data >> 5) & 0x01) != (lsReceived & 0x01) || lsReceived - lsTick >= LOCKSTEP_BUFFER) {
+            lsDesync = 1; // lost or extra byte
+            continue;
+        }
+        signed char delta = data & 0x1F;
+        if (delta & 0x10) { delta -= 32; }
+        lsRemotePos += delta;
+        lsRemote[lsReceived % LOCKSTEP_BUFFER] = lsRemotePos | ((data & 0x40) << 1);
+        lsReceived++;
+    }
+}
+
+/* Sends the local input for the next unsent tick, if the input delay allows it.
+   pos is the paddle top edge (0-127), button the raw start button level. */
+void lockstep_send(unsigned char pos, unsigned char button) {
+    if (lsSent >= lsTick + LOCKSTEP_DELAY) { return; }
+    int delta = (int)pos - lsLocalPos;
+    if (delta > 15) { delta = 15; }
+    if (delta < -16) { delta = -16; }
+    lsLocalPos += delta;
+    lsLocal[lsSent % LOCKSTEP_BUFFER] = lsLocalPos | (button ? 0x80 : 0);
+    serial_char((button ? 0x40 : 0) | ((lsSent & 0x01) << 5) | (delta & 0x1F));
+    lsSent++;
+}
+
+/* Returns 1 when both inputs for the next tick are known. */
+unsigned char lockstep_ready() {
+    return lsReceived > lsTick;
+}
+
+/* Loads lsPaddle and lsButton with the inputs of the next tick. Call only when lockstep_ready(). */
+void lockstep_step() {
+    unsigned char local = lsLocal[lsTick % LOCKSTEP_BUFFER];
+    unsigned char remote = lsRemote[lsTick % LOCKSTEP_BUFFER];
+    lsPaddle[lsRole - 1] = local & 0x7F;
+    lsPaddle[2 - lsRole] = remote & 0x7F;
+    lsButton = (local | remote) >> 7;
+    lsTick++;
+}
+
+/* Called after each simulated tick with the game state checksum; exchanges it every
+   LOCKSTEP_CHECK_INTERVAL ticks. */
+void lockstep_commit(unsigned char check) {
+    if ((lsTick - 1) % LOCKSTEP_CHECK_INTERVAL != 0) { return; }
+    lsLocalCheck = 0x80 | (check & 0x7F);
+    serial_char(lsLocalCheck);
+    lockstep_compare();
+}
+
+#endif /* LOCKSTEP_H */
@@ -2,6 +2,7 @@
 #define SerialAtmega
 #include <avr/io.h>
 #include <avr/interrupt.h>
+#include <avr/pgmspace.h>
 
 void serial_init (int baud ) {
     UBRR0 = (((16000000/(baud*16UL)))-1) ; // Set baud rate
@@ -19,16 +20,36 @@ void serial_char(char ch )
     UDR0 = ch ;
 }
 
+//returns 1 if a received char is waiting
+unsigned char serial_available()
+{
+    return (UCSR0A & (1 << RXC0)) != 0;
+}
+
+//reads a received char
+unsigned char serial_read()
+{
+    return UDR0;
+}
+
+//sends a string stored in flash without a newline
+void serial_print_P(const char *str){
+    char c;
+    while ((c = pgm_read_byte(str++)) != '\0'){
+        serial_char(c);
+    }
+}
+
 //sends a string
 void serial_println(char *str){
-    for (int i; str[i] != '\0'; i++){
+    for (int i = 0; str[i] != '\0'; i++){
         serial_char(str[i]);
     }
     serial_char('\n');
 }
 
-//sends an long. can be used with integers
-void serial_println(long num, int base = 10){
+//sends a long without a newline. can be used with integers
+void serial_print(long num, int base = 10){
     char arr[sizeof(long)*8 + 1]; //array with size of largest possible number of digits for long
     char *str = &arr[sizeof(arr) - 1]; //point to last val in buff
     *str = '\0'; //set last val in buff to null terminator
@@ -46,6 +67,12 @@ void serial_println(long num, int base = 10){
             *str = temp < 10 ? temp + '0' : temp + 'A' - 10; // "+ A - 10" for A-F hex vals
         }
     }
-    serial_println(str);//print from str to end of arr
+    while (*str) { serial_char(*str++); }
+}
+
+//sends an long. can be used with integers
+void serial_println(long num, int base = 10){
+    serial_print(num, base);
+    serial_char('\n');
 }
 #endif
\ No newline at end of file
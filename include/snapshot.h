@@ -0,0 +1,62 @@
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+// Tear-free copies of the game state for code running outside TimerISR().
+// The scheduler tick is the only writer: it bumps seq to odd, rewrites the
+// snapshot and bumps seq back to even. Readers copy it and retry if seq was odd
+// or changed meanwhile. The writer runs in the ISR and can't be interrupted by a
+// reader, so readers never block it and never need to disable interrupts.
+
+// Keeps the compiler from moving memory accesses across the seq updates
+#define SNAPSHOT_BARRIER() __asm__ __volatile__("" ::: "memory")
+
+typedef struct _gameSnapshot {
+    unsigned char ballLoc[4]; // in order: xs, xe, ys, ye
+    signed char ballVec[2]; // in order: x, y
+    unsigned char player1Loc[4];
+    unsigned char player2Loc[4];
+    unsigned char pointScored;
+    unsigned char newRally;
+    unsigned char player1Score;
+    unsigned char player2Score;
+    unsigned char numPlayers;
+    unsigned char winner;
+    unsigned char gameStatus;
+#ifdef TICK_STATS
+    unsigned char frameHz; // achieved tick rate over the last window
+    unsigned char rateWindows; // changes when frameHz is updated
+    unsigned short overruns;
+    unsigned short shedCount[3]; // info display, medal redraw, AI
+#endif
+} gameSnapshot;
+
+typedef struct _snapshotBuffer {
+    volatile unsigned char seq; // odd while a write is in progress
+    gameSnapshot data;
+} snapshotBuffer;
+
+/* Writer side: call before and after updating b->data. */
+void snapshot_begin(snapshotBuffer *b) {
+    b->seq++;
+    SNAPSHOT_BARRIER();
+}
+
+void snapshot_end(snapshotBuffer *b) {
+    SNAPSHOT_BARRIER();
+    b->seq++;
+}
+
+/* Copies a consistent snapshot into out. Returns its sequence number, which
+   changes every time a new one is published. */
+unsigned char snapshot_read(const snapshotBuffer *b, gameSnapshot *out) {
+    unsigned char seq;
+    do {
+        do { seq = b->seq; } while (seq & 0x01);
+        SNAPSHOT_BARRIER();
+        *out = b->data;
+        SNAPSHOT_BARRIER();
+    } while (b->seq != seq);
+    return seq;
+}
+
+#endif /* SNAPSHOT_H */
@@ -0,0 +1,22 @@
+#ifndef SPRITE_H
+#define SPRITE_H
+#include <avr/pgmspace.h>
+
+// Run-length encoded sprites in flash, drawn with displaySprite() in ST7735_LCD.h.
+// The pixels are a list of runs in raster order, each one byte rrrrriii: palette
+// entry iii repeated rrrrr + 1 times. A run may wrap onto the next row, which is
+// how the display's RAMWR window fills too, so runs are streamed out as they are
+// read. scripts/make_sprites.py generates them into sprites.h.
+
+typedef struct _sprite {
+    unsigned char width;
+    unsigned char height;
+    unsigned short runCount;
+    const unsigned short *palette; // RGB565, up to 8 colors, in PROGMEM
+    const unsigned char *runs; // in PROGMEM
+} sprite;
+
+#define SPRITE_RUN_LENGTH(run) (((run) >> 3) + 1)
+#define SPRITE_RUN_INDEX(run) ((run) & 0x07)
+
+#endif /* SPRITE_H */
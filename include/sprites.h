@@ -0,0 +1,58 @@
+// Generated by scripts/make_sprites.py, do not edit.
+#ifndef SPRITES_H
+#define SPRITES_H
+#include "sprite.h"
+
+// round ball: 5x5, 7 runs (50 bytes unencoded)
+const unsigned short ballPalette[] PROGMEM = {0x0000, 0xFFFF};
+const unsigned char ballRuns[] PROGMEM = {
+    0x00, 0x11, 0x00, 0x71, 0x00, 0x11, 0x00,
+};
+const sprite ballSprite PROGMEM = {5, 5, sizeof(ballRuns), ballPalette, ballRuns};
+
+// medal, gold by default: 31x31, 121 runs (1922 bytes unencoded)
+const unsigned short medalPalette[] PROGMEM = {0x0000, 0x001F, 0xF800, 0xAAE0, 0x61A0, 0xFC40};
+const unsigned char medalRuns[] PROGMEM = {
+    0x40, 0x29, 0x32, 0x88, 0x29, 0x32, 0x88, 0x29, 0x32, 0x90, 0x21, 0x2A, 0x98, 0x21, 0x2A, 0x98,
+    0x21, 0x2A, 0xA0, 0x19, 0x22, 0xA8, 0x19, 0x22, 0xA8, 0x19, 0x04, 0x1A, 0xA8, 0x44, 0x98, 0x14,
+    0x33, 0x14, 0x80, 0x0C, 0x53, 0x0C, 0x70, 0x0C, 0x63, 0x0C, 0x60, 0x0C, 0x0B, 0x15, 0x4B, 0x0C,
+    0x58, 0x04, 0x0B, 0x25, 0x4B, 0x04, 0x50, 0x0C, 0x0B, 0x25, 0x4B, 0x0C, 0x48, 0x04, 0x13, 0x25,
+    0x53, 0x04, 0x48, 0x04, 0x1B, 0x15, 0x5B, 0x04, 0x48, 0x04, 0x93, 0x04, 0x40, 0x0C, 0x93, 0x0C,
+    0x40, 0x04, 0x93, 0x04, 0x48, 0x04, 0x93, 0x04, 0x48, 0x04, 0x93, 0x04, 0x48, 0x0C, 0x83, 0x0C,
+    0x50, 0x04, 0x83, 0x04, 0x58, 0x0C, 0x73, 0x0C, 0x60, 0x0C, 0x63, 0x0C, 0x70, 0x0C, 0x53, 0x0C,
+    0x80, 0x14, 0x33, 0x14, 0x98, 0x44, 0xC8, 0x04, 0x70,
+};
+const sprite medalSprite PROGMEM = {31, 31, sizeof(medalRuns), medalPalette, medalRuns};
+
+// medal recolored for the losing side
+const unsigned short bronzePalette[] PROGMEM = {0x0000, 0x001F, 0xF800, 0x1860, 0x0820, 0x30C0};
+
+// title screen: 46x38, 342 runs (3496 bytes unencoded)
+const unsigned short titlePalette[] PROGMEM = {0x0000, 0xFFFF, 0xAAE0};
+const unsigned char titleRuns[] PROGMEM = {
+    0x39, 0x28, 0x29, 0x18, 0x09, 0x28, 0x09, 0x18, 0x29, 0x08, 0x39, 0x28, 0x29, 0x18, 0x09, 0x28,
+    0x09, 0x18, 0x29, 0x08, 0x09, 0x28, 0x09, 0x28, 0x09, 0x28, 0x19, 0x18, 0x09, 0x08, 0x09, 0x28,
+    0x19, 0x28, 0x09, 0x28, 0x09, 0x28, 0x19, 0x18, 0x09, 0x08, 0x09, 0x28, 0x19, 0x28, 0x09, 0x28,
+    0x09, 0x28, 0x09, 0x08, 0x09, 0x08, 0x09, 0x08, 0x09, 0x38, 0x09, 0x28, 0x09, 0x28, 0x09, 0x28,
+    0x09, 0x08, 0x09, 0x08, 0x09, 0x08, 0x09, 0x38, 0x39, 0x38, 0x09, 0x28, 0x09, 0x08, 0x09, 0x08,
+    0x09, 0x08, 0x09, 0x08, 0x69, 0x38, 0x09, 0x28, 0x09, 0x08, 0x09, 0x08, 0x09, 0x08, 0x09, 0x08,
+    0x39, 0x68, 0x09, 0x28, 0x09, 0x18, 0x19, 0x08, 0x09, 0x28, 0x19, 0x68, 0x09, 0x28, 0x09, 0x18,
+    0x19, 0x08, 0x09, 0x28, 0x19, 0x68, 0x09, 0x28, 0x09, 0x28, 0x09, 0x08, 0x09, 0x28, 0x19, 0x68,
+    0x09, 0x28, 0x09, 0x28, 0x09, 0x08, 0x09, 0x28, 0x19, 0x58, 0x29, 0x18, 0x09, 0x28, 0x09, 0x18,
+    0x49, 0x58, 0x29, 0x18, 0x09, 0x28, 0x09, 0x18, 0x39, 0xF8, 0x68, 0xFA, 0xFA, 0xDA, 0xF8, 0xF8,
+    0xD8, 0x39, 0x28, 0x29, 0x18, 0x09, 0x28, 0x09, 0x18, 0x29, 0x08, 0x39, 0x28, 0x29, 0x18, 0x09,
+    0x28, 0x09, 0x18, 0x29, 0x08, 0x09, 0x28, 0x09, 0x08, 0x09, 0x28, 0x09, 0x08, 0x19, 0x18, 0x09,
+    0x08, 0x09, 0x28, 0x19, 0x28, 0x09, 0x08, 0x09, 0x28, 0x09, 0x08, 0x19, 0x18, 0x09, 0x08, 0x09,
+    0x28, 0x19, 0x28, 0x09, 0x08, 0x09, 0x28, 0x09, 0x08, 0x09, 0x08, 0x09, 0x08, 0x09, 0x08, 0x09,
+    0x38, 0x09, 0x28, 0x09, 0x08, 0x09, 0x28, 0x09, 0x08, 0x09, 0x08, 0x09, 0x08, 0x09, 0x08, 0x09,
+    0x38, 0x39, 0x18, 0x09, 0x28, 0x09, 0x08, 0x09, 0x08, 0x09, 0x08, 0x09, 0x08, 0x09, 0x08, 0x69,
+    0x18, 0x09, 0x28, 0x09, 0x08, 0x09, 0x08, 0x09, 0x08, 0x09, 0x08, 0x09, 0x08, 0x39, 0x48, 0x09,
+    0x28, 0x09, 0x08, 0x09, 0x18, 0x19, 0x08, 0x09, 0x28, 0x19, 0x48, 0x09, 0x28, 0x09, 0x08, 0x09,
+    0x18, 0x19, 0x08, 0x09, 0x28, 0x19, 0x48, 0x09, 0x28, 0x09, 0x08, 0x09, 0x28, 0x09, 0x08, 0x09,
+    0x28, 0x19, 0x48, 0x09, 0x28, 0x09, 0x08, 0x09, 0x28, 0x09, 0x08, 0x09, 0x28, 0x19, 0x58, 0x29,
+    0x18, 0x09, 0x28, 0x09, 0x18, 0x49, 0x58, 0x29, 0x18, 0x09, 0x28, 0x09, 0x18, 0x39, 0xF8, 0x68,
+    0xFA, 0xFA, 0xDA, 0xF8, 0xF8, 0xD8,
+};
+const sprite titleSprite PROGMEM = {46, 38, sizeof(titleRuns), titlePalette, titleRuns};
+
+#endif /* SPRITES_H */
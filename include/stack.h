@@ -0,0 +1,43 @@
+#ifndef STACK_H
+#define STACK_H
+#include <avr/io.h>
+
+// Stack painting. Before main() runs, every byte between the end of .bss and
+// the top of RAM is filled with STACK_CANARY. The stack grows down from RAMEND,
+// so the canary bytes that are still intact above .bss are RAM the stack has
+// never reached.
+
+#define STACK_CANARY 0xC5
+
+extern unsigned char _end; // first byte after .bss, from the linker
+extern unsigned char __stack; // top of RAM
+
+// Runs from .init3: after the zero register and stack pointer are set up,
+// before .data/.bss are copied and cleared. No call frame, so nothing it
+// paints is in use yet.
+void stack_paint(void) __attribute__((naked, used, section(".init3")));
+void stack_paint(void) {
+    unsigned char *p = &_end;
+    while (p <= &__stack) {
+        *p = STACK_CANARY;
+        p++;
+    }
+}
+
+/* Bytes of RAM the stack has never touched since reset (the headroom left). */
+unsigned int stack_unused(void) {
+    const unsigned char *p = &_end;
+    unsigned int count = 0;
+    while (p <= &__stack && *p == STACK_CANARY) {
+        p++;
+        count++;
+    }
+    return count;
+}
+
+/* Deepest stack use since reset, in bytes. */
+unsigned int stack_high_water(void) {
+    return (unsigned int)(&__stack - &_end) + 1 - stack_unused();
+}
+
+#endif /* STACK_H */
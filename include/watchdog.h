@@ -0,0 +1,92 @@
+#ifndef WATCHDOG_H
+#define WATCHDOG_H
+#include <avr/io.h>
+#include <avr/wdt.h>
+#include <avr/pgmspace.h>
+#include "crashlog.h"
+#include "serialATMega.h"
+
+// The scheduler runs under the watchdog: TimerISR() kicks it every tick, so a
+// task that never returns resets the unit after WDT_TIMEOUT. On the next boot
+// crash_report() prints the crash record from crashlog.h if it shows a tick
+// that never finished. That is decided from the record alone, because the
+// Optiboot bootloader clears MCUSR before the sketch starts. The reset cause is
+// printed as well when it is known: a watchdog reset points at a timing overrun
+// or a wait on a peripheral that never answered, a brown-out or external reset
+// at power or wiring.
+
+#define WDT_TIMEOUT WDTO_500MS // well above the longest blocking LCD1602 tick
+
+#define RESET_FLAGS ((1 << PORF) | (1 << EXTRF) | (1 << BORF) | (1 << WDRF))
+
+unsigned char resetCause __attribute__((section(".noinit"))); // MCUSR flags at reset, 0 if unknown
+unsigned char bootR2 __attribute__((section(".noinit"))); // r2 as the bootloader left it
+
+// Runs from .init0, before the C runtime touches any register: Optiboot 6 and
+// later leave the MCUSR value it cleared in r2. Other bootloaders leave
+// whatever r2 happened to hold.
+void crash_save_boot_r2(void) __attribute__((naked, used, section(".init0")));
+void crash_save_boot_r2(void) {
+    __asm__ __volatile__("sts %0, r2" : "=m"(bootR2));
+}
+
+// Runs from .init3, before anything else can take long: a watchdog reset
+// leaves the watchdog running at its shortest timeout, so it is stopped here.
+// Without a bootloader MCUSR still holds the reset cause; with one, it reads 0.
+// The saved r2 is only trusted when it holds nothing but reset flags, so
+// garbage from an older bootloader leaves the cause unknown.
+void crash_save_reset(void) __attribute__((naked, used, section(".init3")));
+void crash_save_reset(void) {
+    resetCause = MCUSR | ((bootR2 & ~RESET_FLAGS) ? 0 : bootR2);
+    MCUSR = 0;
+    wdt_disable();
+}
+
+/* Prints the reset cause and, if the last run died inside a tick, the crash
+   record and the last task timings, oldest first, converted to microseconds at
+   usPerCount. Then starts a fresh record. */
+void crash_report(unsigned int usPerCount) {
+    serial_print_P(PSTR("reset "));
+    if (resetCause) {
+        serial_println(resetCause, 16);
+    } else {
+        serial_print_P(PSTR("unknown"));
+        serial_char('\n');
+    }
+    if (crash_pending()) {
+        serial_print_P(PSTR("unfinished tick "));
+        serial_print(crashLog.ticks);
+        if (crashLog.task == CRASH_IDLE) {
+            serial_print_P(PSTR(" between tasks"));
+        } else {
+            serial_print_P(PSTR(" task "));
+            serial_print(crashLog.task);
+            serial_print_P(PSTR(" state "));
+            serial_print(crashLog.state);
+            serial_print_P(PSTR(" at us "));
+            serial_print((unsigned long)crashLog.taskStartCounts * usPerCount);
+        }
+        serial_char('\n');
+        for (unsigned char i = 0; i < CRASH_TIMINGS; i++) {
+            const taskTiming *t = &crashLog.timings[(crashLog.next + i) % CRASH_TIMINGS];
+            if (t->task == CRASH_IDLE) { continue; } // slot never used
+            serial_print_P(PSTR("task "));
+            serial_print(t->task);
+            serial_print_P(PSTR(" us "));
+            serial_println((unsigned long)t->counts * usPerCount);
+        }
+    }
+    crash_clear();
+}
+
+/* Arms the watchdog. Until then a hang during boot just hangs. */
+void watchdog_start(void) {
+    wdt_enable(WDT_TIMEOUT);
+}
+
+/* Called once per scheduler tick. */
+void watchdog_kick(void) {
+    wdt_reset();
+}
+
+#endif /* WATCHDOG_H */
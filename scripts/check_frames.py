@@ -0,0 +1,98 @@
+# Golden-frame regression check. Builds the host frame capture (src/host/frames.cpp)
+# for each configuration below, runs the scripted game and compares the SHA-256 of
+# every sampled ST7735 frame against test/golden/<name>.sha256. A few of the frames
+# are kept as PPMs in test/golden/<name>/ to look at.
+#   python scripts/check_frames.py            compare, exit 1 on any difference
+#   python scripts/check_frames.py --update   rewrite the hashes and reference frames
+# Needs a host C++ compiler ($CXX, default c++). Run it from anywhere.
+import hashlib
+import os
+import shutil
+import subprocess
+import sys
+import tempfile
+
+ROOT = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+GOLDEN = os.path.join(ROOT, "test", "golden")
+
+# name, build flags, ticks, every Nth frame
+CONFIGS = (
+    ("default", [], 2400, 40),
+    ("hud", ["-DHUD"], 2400, 40),
+    ("high_refresh", ["-DHIGH_REFRESH", "-DHUD"], 6000, 100),
+)
+
+
+def build(flags, exe):
+    cxx = os.environ.get("CXX", "c++")
+    cmd = [cxx, "-std=gnu++17", "-O2", "-Wall", "-I" + os.path.join(ROOT, "host"),
+           "-I" + os.path.join(ROOT, "include")] + flags + [os.path.join(ROOT, "src", "host", "frames.cpp"), "-o", exe]
+    subprocess.run(cmd, check=True)
+
+
+def hash_frames(folder):
+    """Returns {file name: sha256 hex} for every frame in folder."""
+    hashes = {}
+    for frame in sorted(os.listdir(folder)):
+        with open(os.path.join(folder, frame), "rb") as f:
+            hashes[frame] = hashlib.sha256(f.read()).hexdigest()
+    return hashes
+
+
+def read_manifest(path):
+    hashes = {}
+    with open(path) as f:
+        for line in f:
+            digest, frame = line.split()
+            hashes[frame] = digest
+    return hashes
+
+
+def write_manifest(path, hashes):
+    with open(path, "w") as f:
+        for frame in sorted(hashes):
+            f.write("%s  %s\n" % (hashes[frame], frame))
+
+
+def keep_references(frames, golden):
+    """Copies the first, middle and last frame into golden as reference PPMs."""
+    shutil.rmtree(golden, ignore_errors=True)
+    os.makedirs(golden)
+    names = sorted(os.listdir(frames))
+    for frame in sorted({names[0], names[len(names) // 2], names[-1]}):
+        shutil.copy(os.path.join(frames, frame), os.path.join(golden, frame))
+
+
+def main(update):
+    failed = []
+    with tempfile.TemporaryDirectory() as tmp:
+        for name, flags, ticks, every in CONFIGS:
+            exe = os.path.join(tmp, "frames_" + name)
+            build(flags, exe)
+            frames = os.path.join(tmp, name)
+            os.makedirs(frames)
+            result = subprocess.run([exe, "-n", str(ticks), "-e", str(every), "-o", frames],
+                                    stdout=subprocess.DEVNULL, stderr=subprocess.PIPE, text=True)
+            if result.returncode != 0:
+                sys.stderr.write(result.stderr)
+                print("%-13s FAILED" % name)
+                failed.append(name)
+                continue
+            hashes = hash_frames(frames)
+            manifest = os.path.join(GOLDEN, name + ".sha256")
+            if update:
+                write_manifest(manifest, hashes)
+                keep_references(frames, os.path.join(GOLDEN, name))
+                print("%-13s written" % name)
+                continue
+            expected = read_manifest(manifest)
+            differ = sorted(frame for frame in set(expected) | set(hashes) if expected.get(frame) != hashes.get(frame))
+            print("%-13s %s" % (name, "FAILED" if differ else "ok"))
+            if differ:
+                sys.stderr.write("%d frame(s) differ: %s\n" % (len(differ), " ".join(differ)))
+                failed.append(name)
+    return 1 if failed else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main("--update" in sys.argv[1:]))
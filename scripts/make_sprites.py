@@ -0,0 +1,130 @@
+# Generates include/sprites.h: the game's sprites as run-length encoded RGB565
+# images for displaySprite() in ST7735_LCD.h.
+#   python scripts/make_sprites.py > include/sprites.h
+#
+# Each sprite is a palette of up to 8 colors and a run list over its pixels in
+# raster order (rows top to bottom, left to right within a row). A run is one
+# byte, rrrrriii: palette index iii repeated rrrrr + 1 times, so a run covers
+# 1 to 32 pixels and may continue onto the next row.
+import math
+
+BACKGROUND = 0x0000
+WHITE = 0xFFFF
+GOLD = 0xAAE0   # Game::GOLD_COLOR
+BROWN = 0x1860  # Game::BROWN_COLOR
+MAX_RUN = 32
+
+
+def rgb565(r, g, b):
+    return ((r >> 3) << 11) | ((g >> 2) << 5) | (b >> 3)
+
+
+def shade(color, factor):
+    """Scales an RGB565 color's channels, clamped to their maximums."""
+    r, g, b = color >> 11, (color >> 5) & 0x3F, color & 0x1F
+    return (min(31, int(r * factor)) << 11) | (min(63, int(g * factor)) << 5) | min(31, int(b * factor))
+
+
+def encode(pixels):
+    runs = []
+    i = 0
+    while i < len(pixels):
+        n = 1
+        while i + n < len(pixels) and pixels[i + n] == pixels[i] and n < MAX_RUN:
+            n += 1
+        runs.append(((n - 1) << 3) | pixels[i])
+        i += n
+    return runs
+
+
+def ball():
+    """5x5 disc, index 1 on a background of index 0."""
+    rows = [".###.", "#####", "#####", "#####", ".###."]
+    return 5, 5, [0 if c == "." else 1 for row in rows for c in row]
+
+
+def medal():
+    """31x31 medal on a ribbon. 0 background, 1/2 ribbon stripes, 3 body, 4 rim, 5 highlight."""
+    w = h = 31
+    cx, cy, r = 15, 19, 11
+    pixels = []
+    for y in range(h):
+        for x in range(w):
+            d = math.hypot(x - cx, y - cy)
+            if d <= r - 1.5:
+                hx, hy = x - (cx - 4), y - (cy - 4)
+                pixels.append(5 if hx * hx + hy * hy <= 6 else 3)
+            elif d <= r:
+                pixels.append(4)
+            elif y <= 10 and abs(x - cx) <= 6 - y // 3 and y >= 0:
+                pixels.append(1 if x < cx else 2)
+            else:
+                pixels.append(0)
+    return w, h, pixels
+
+
+FONT_5X7 = {
+    "P": ["####.", "#...#", "#...#", "####.", "#....", "#....", "#...."],
+    "I": [".###.", "..#..", "..#..", "..#..", "..#..", "..#..", ".###."],
+    "N": ["#...#", "##..#", "#.#.#", "#.#.#", "#..##", "#...#", "#...#"],
+    "G": [".###.", "#...#", "#....", "#.###", "#...#", "#...#", ".####"],
+    "O": [".###.", "#...#", "#...#", "#...#", "#...#", "#...#", ".###."],
+}
+
+
+def title(lines=("PING", "PONG"), scale=2):
+    """The lines in a 5x7 font at scale, each over a two pixel underline.
+    0 background, 1 letters, 2 underline."""
+    advance = 6 * scale
+    line_h = 7 * scale + 5
+    w = advance * max(len(line) for line in lines) - scale
+    h = line_h * len(lines)
+    pixels = [0] * (w * h)
+    for j, text in enumerate(lines):
+        top = j * line_h
+        for i, ch in enumerate(text):
+            for gy, row in enumerate(FONT_5X7[ch]):
+                for gx, c in enumerate(row):
+                    if c != "#":
+                        continue
+                    for sy in range(scale):
+                        for sx in range(scale):
+                            pixels[(top + gy * scale + sy) * w + i * advance + gx * scale + sx] = 1
+        for y in (top + 7 * scale + 1, top + 7 * scale + 2):
+            for x in range(w):
+                pixels[y * w + x] = 2
+    return w, h, pixels
+
+
+def emit(name, size, palette, comment):
+    w, h, pixels = size
+    runs = encode(pixels)
+    print("// %s: %dx%d, %d runs (%d bytes unencoded)" % (comment, w, h, len(runs), w * h * 2))
+    print("const unsigned short %sPalette[] PROGMEM = {%s};" % (name, ", ".join("0x%04X" % c for c in palette)))
+    print("const unsigned char %sRuns[] PROGMEM = {" % name)
+    for i in range(0, len(runs), 16):
+        print("    " + ", ".join("0x%02X" % r for r in runs[i:i + 16]) + ",")
+    print("};")
+    print("const sprite %sSprite PROGMEM = {%d, %d, sizeof(%sRuns), %sPalette, %sRuns};" % (name, w, h, name, name, name))
+    print()
+
+
+def main():
+    print("// Generated by scripts/make_sprites.py, do not edit.")
+    print("#ifndef SPRITES_H")
+    print("#define SPRITES_H")
+    print('#include "sprite.h"')
+    print()
+    emit("ball", ball(), [BACKGROUND, WHITE], "round ball")
+    medal_palette = [BACKGROUND, rgb565(0, 0, 255), rgb565(255, 0, 0), GOLD, shade(GOLD, 0.6), shade(GOLD, 1.5)]
+    emit("medal", medal(), medal_palette, "medal, gold by default")
+    print("// medal recolored for the losing side")
+    print("const unsigned short bronzePalette[] PROGMEM = {%s};" % ", ".join(
+        "0x%04X" % c for c in [BACKGROUND, rgb565(0, 0, 255), rgb565(255, 0, 0), BROWN, shade(BROWN, 0.6), shade(BROWN, 2.0)]))
+    print()
+    emit("title", title(), [BACKGROUND, WHITE, GOLD], "title screen")
+    print("#endif /* SPRITES_H */")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,61 @@
+# PlatformIO post-build step: prints a per-symbol .data/.bss/.noinit/.text budget for the
+# firmware and how much of the ATmega328's 2 KB of SRAM is left for the stack.
+# Hooked up with `extra_scripts = post:scripts/size_report.py`; also runs standalone:
+#   python scripts/size_report.py .pio/build/uno/firmware.elf [avr-objdump]
+import subprocess
+import sys
+
+RAM_SIZE = 2048
+FLASH_SIZE = 32256  # 32 KB minus the Optiboot bootloader
+SECTIONS = (".data", ".bss", ".noinit", ".text")
+
+
+def symbol_sizes(elf, objdump):
+    """Returns {section: [(size, name), ...]} from the ELF symbol table."""
+    out = subprocess.run([objdump, "-t", "-C", elf], check=True, capture_output=True, text=True).stdout
+    symbols = {section: [] for section in SECTIONS}
+    for line in out.splitlines():
+        # 00800100 l     O .data\t00000006 name, where demangled names may contain spaces
+        head, tab, tail = line.partition("\t")
+        if not tab or not head.split() or head.split()[-1] not in symbols:
+            continue
+        size, _, name = tail.strip().partition(" ")
+        section, size = head.split()[-1], int(size, 16)
+        if size:
+            symbols[section].append((size, name.strip()))
+    return symbols
+
+
+def section_sizes(elf, objdump):
+    out = subprocess.run([objdump, "-h", elf], check=True, capture_output=True, text=True).stdout
+    sizes = {section: 0 for section in SECTIONS}
+    for line in out.splitlines():
+        parts = line.split()
+        if len(parts) >= 3 and parts[1] in sizes:
+            sizes[parts[1]] = int(parts[2], 16)
+    return sizes
+
+
+def report(elf, objdump, top=15):
+    symbols = symbol_sizes(elf, objdump)
+    sizes = section_sizes(elf, objdump)
+    for section in SECTIONS:
+        print("%s: %d bytes" % (section, sizes[section]))
+        for size, name in sorted(symbols[section], reverse=True)[:top]:
+            print("  %6d  %s" % (size, name))
+    ram = sizes[".data"] + sizes[".bss"] + sizes[".noinit"]
+    flash = sizes[".text"] + sizes[".data"]
+    print("flash: %d / %d bytes (%.1f%%)" % (flash, FLASH_SIZE, 100.0 * flash / FLASH_SIZE))
+    print("static RAM: %d / %d bytes, %d left for the stack" % (ram, RAM_SIZE, RAM_SIZE - ram))
+
+
+if __name__ == "__main__":
+    report(sys.argv[1], sys.argv[2] if len(sys.argv) > 2 else "avr-objdump")
+else:
+    Import("env")  # noqa: F821 - provided by PlatformIO
+
+    def size_report(source, target, env):
+        objdump = env.subst("$CC").replace("gcc", "objdump")
+        report(str(target[0]), objdump)
+
+    env.AddPostAction("$BUILD_DIR/${PROGNAME}.elf", size_report)  # noqa: F821
@@ -0,0 +1,283 @@
+// Host-side check and benchmark for the paddle collision kernel, for the
+// [env:native_collision] build. Game::checkCollision() is compared against the
+// original hard-coded version (legacyCollision below) on
+//   - a rally corpus: the game state after every tick of scripted one and two
+//     player games, recorded here or loaded from a file, and
+//   - every ball position and y velocity against every paddle position.
+// Both are then timed over the whole corpus and over the states with the ball
+// in a paddle's column, in TSC cycles on x86 hosts (ns elsewhere). This is host
+// timing: on the AVR the kernel also saves the 16-bit compares the original
+// zone tests were promoted to.
+//
+// usage: collision_bench [-n ticks] [-r corpus] [-c corpus] [-k reps]
+//   -n  ticks per scripted game when recording (default 20000)
+//   -r  also write the recorded corpus to this file
+//   -c  load the corpus from this file instead of recording one
+//   -k  timing passes over the corpus (default 200)
+// Exits 1 if any outcome differs.
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <vector>
+#include "host_backends.h"
+#include "game.h"
+#include "backends.h"
+
+typedef Game<NullDisplay, PotInput, HostClock> G;
+
+/* Everything checkCollision() reads or writes. */
+typedef struct _collisionState {
+    unsigned char ballLoc[4];
+    signed char ballVec[2];
+    unsigned char player1Loc[4];
+    unsigned char player2Loc[4];
+} collisionState;
+
+void loadState(const collisionState *c) {
+    memcpy(G::ballLoc, c->ballLoc, 4);
+    memcpy(G::ballVec, c->ballVec, 2);
+    memcpy(G::player1Loc, c->player1Loc, 4);
+    memcpy(G::player2Loc, c->player2Loc, 4);
+}
+
+void saveState(collisionState *c) {
+    memcpy(c->ballLoc, G::ballLoc, 4);
+    memcpy(c->ballVec, G::ballVec, 2);
+    memcpy(c->player1Loc, G::player1Loc, 4);
+    memcpy(c->player2Loc, G::player2Loc, 4);
+}
+
+/* checkCollision() as it was before the deflection table, kept as the reference. */
+int legacyCollision(void) {
+    unsigned char *ballLoc = G::ballLoc;
+    signed char *ballVec = G::ballVec;
+    unsigned char *player1Loc = G::player1Loc;
+    unsigned char *player2Loc = G::player2Loc;
+
+    // side walls
+    if (ballLoc[2] <= 2 || ballLoc[3] >= 127) {
+        ballVec[1] *= -1;
+    }
+
+    // paddle 1
+    if ((ballLoc[0] >= player1Loc[0] && ballLoc[0] <= player1Loc[1])) {
+        // adjust vector based on where on the paddle it hits
+        if (ballLoc[3] >= player1Loc[2] && ballLoc[3] <= player1Loc[2] + 8) {
+            ballVec[0] *= -1;
+            ballVec[1] += 1;
+        }
+        else if (ballLoc[3] >= player1Loc[2] + 8 && ballLoc[3] <= player1Loc[3] - 8) {
+            ballVec[0] *= -1;
+            ballVec[1] -= 1;
+        }
+        else if (ballLoc[3] >= player1Loc[3] - 8 && ballLoc[2] <= player1Loc[3]) {
+            ballVec[0] *= -1;
+            ballVec[1] += 1;
+        }
+        else {}
+        if (ballVec[1] > 3) { ballVec[1] = 3; }
+        if (ballVec[1] < -3) { ballVec[1] = -3; }
+    }
+
+    // paddle 2
+    if (ballLoc[1] >= player2Loc[0] && ballLoc[1] <= player2Loc[1]) {
+        // adjust vector based on where on the paddle it hits
+        if (ballLoc[3] >= player2Loc[2] && ballLoc[3] <= player2Loc[2] + 8) {
+            ballVec[0] *= -1;
+            ballVec[1] += 1;
+        }
+        else if (ballLoc[3] >= player2Loc[2] + 8 && ballLoc[3] <= player2Loc[3] - 8) {
+            ballVec[0] *= -1;
+            ballVec[1] -= 1;
+        }
+        else if (ballLoc[3] >= player2Loc[3] - 8 && ballLoc[2] <= player2Loc[3]) {
+            ballVec[0] *= -1;
+            ballVec[1] += 1;
+        }
+        else {}
+        if (ballVec[1] > 3) { ballVec[1] = 3; }
+        if (ballVec[1] < -3) { ballVec[1] = -3; }
+    }
+
+    // behind paddle 1
+    if (ballLoc[0] <= 6) {
+        ballLoc[0] = 62;
+        ballLoc[1] = 62 + G::BALL_DIAMETER;
+        ballLoc[2] = 62;
+        ballLoc[3] = 62 + G::BALL_DIAMETER;
+        return 2;
+    }
+
+    // behind paddle 2
+    if (ballLoc[1] >= 123) {
+        ballLoc[0] = 62;
+        ballLoc[1] = 62 + G::BALL_DIAMETER;
+        ballLoc[2] = 62;
+        ballLoc[3] = 62 + G::BALL_DIAMETER;
+        return 1;
+    }
+
+    return 0;
+}
+
+/* Runs both versions from state c. Returns 1 if the results differ. */
+int differs(const collisionState *c) {
+    collisionState legacy, kernel;
+    loadState(c);
+    int legacyPoint = legacyCollision();
+    saveState(&legacy);
+    loadState(c);
+    int kernelPoint = G::checkCollision();
+    saveState(&kernel);
+    return legacyPoint != kernelPoint || memcmp(&legacy, &kernel, sizeof(legacy)) != 0;
+}
+
+/* Plays a scripted game for ticks ticks and records the state after each one.
+   players 1 presses the mode button first; speed sets how fast the pots sweep. */
+void recordGame(std::vector<collisionState> *corpus, unsigned long ticks, unsigned char players, unsigned long speed) {
+    G::initTasks();
+    for (unsigned long t = 0; t < ticks; t++) {
+        unsigned long ms = t * G::GCD_PERIOD;
+        PINC = SetBit(PINC, 4, players == 1 && ms >= 100 && ms < 300);
+        PINC = SetBit(PINC, 3, (ms >= 500 && ms < 700) || ms % 20000 >= 19700); // start, then restart every 20 s
+        unsigned long phase = (ms * speed / 25) % 2048;
+        host_adc[1] = phase < 1024 ? phase : 2047 - phase;
+        phase = (ms * (speed + 5) / 25) % 2048;
+        host_adc[2] = phase < 1024 ? phase : 2047 - phase;
+        G::tick();
+        collisionState c;
+        saveState(&c);
+        corpus->push_back(c);
+    }
+}
+
+/* Every ball position and y velocity against every position of each paddle.
+   Returns the number of differing states. */
+unsigned long sweep(unsigned long *checked) {
+    unsigned long bad = 0;
+    collisionState c;
+    for (unsigned int paddleY = 0; paddleY < 256; paddleY++) { // off screen and wrapped too, the computer paddle can get there
+        for (unsigned int x = 0; x <= 128; x++) {
+            for (unsigned int y = 0; y <= 128; y++) {
+                for (int vy = -G::BALL_MAX_DY; vy <= G::BALL_MAX_DY; vy++) {
+                    unsigned char p1[4] = {10, 10 + G::PADDLE_DEPTH, (unsigned char)paddleY, (unsigned char)(paddleY + G::PADDLE_WIDTH)};
+                    unsigned char p2[4] = {119 - G::PADDLE_DEPTH, 119, (unsigned char)paddleY, (unsigned char)(paddleY + G::PADDLE_WIDTH)};
+                    c.ballLoc[0] = x;
+                    c.ballLoc[1] = x + G::BALL_DIAMETER;
+                    c.ballLoc[2] = y;
+                    c.ballLoc[3] = y + G::BALL_DIAMETER;
+                    c.ballVec[0] = x < 64 ? -2 : 2;
+                    c.ballVec[1] = vy;
+                    memcpy(c.player1Loc, p1, 4);
+                    memcpy(c.player2Loc, p2, 4);
+                    bad += differs(&c);
+                    (*checked)++;
+                }
+            }
+        }
+    }
+    return bad;
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+const char *TIME_UNIT = "cycles";
+unsigned long long now(void) { return __rdtsc(); }
+#else
+const char *TIME_UNIT = "ns";
+unsigned long long now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+#endif
+
+/* Average time per call of fn over the corpus. The state is reloaded before each call. */
+double timeCalls(int (*fn)(void), const std::vector<collisionState> &corpus, unsigned long reps) {
+    volatile int sink = 0;
+    if (corpus.empty()) { return 0; }
+    unsigned long long start = now();
+    for (unsigned long r = 0; r < reps; r++) {
+        for (size_t i = 0; i < corpus.size(); i++) {
+            loadState(&corpus[i]);
+            sink += fn();
+        }
+    }
+    unsigned long long spent = now() - start;
+    (void)sink;
+    return (double)spent / (reps * corpus.size());
+}
+
+int main(int argc, char **argv) {
+    unsigned long ticks = 20000;
+    unsigned long reps = 200;
+    const char *recordPath = 0;
+    const char *corpusPath = 0;
+    int opt;
+    while ((opt = getopt(argc, argv, "n:r:c:k:")) != -1) {
+        switch (opt) {
+            case 'n': ticks = strtoul(optarg, 0, 10); break;
+            case 'r': recordPath = optarg; break;
+            case 'c': corpusPath = optarg; break;
+            case 'k': reps = strtoul(optarg, 0, 10); break;
+            default:
+                fprintf(stderr, "usage: %s [-n ticks] [-r corpus] [-c corpus] [-k reps]\n", argv[0]);
+                return 2;
+        }
+    }
+
+    std::vector<collisionState> corpus;
+    if (corpusPath) {
+        FILE *f = fopen(corpusPath, "rb");
+        if (!f) { fprintf(stderr, "cannot read %s\n", corpusPath); return 2; }
+        collisionState c;
+        while (fread(&c, sizeof(c), 1, f) == 1) { corpus.push_back(c); }
+        fclose(f);
+    } else {
+        recordGame(&corpus, ticks, 2, 16);
+        recordGame(&corpus, ticks, 1, 16);
+        recordGame(&corpus, ticks, 2, 37);
+        recordGame(&corpus, ticks, 1, 37);
+    }
+    if (recordPath) {
+        FILE *f = fopen(recordPath, "wb");
+        if (!f || fwrite(corpus.data(), sizeof(collisionState), corpus.size(), f) != corpus.size()) {
+            fprintf(stderr, "cannot write %s\n", recordPath);
+            return 2;
+        }
+        fclose(f);
+    }
+
+    unsigned long corpusBad = 0;
+    unsigned long hits = 0;
+    std::vector<collisionState> near; // ball in a paddle's column
+    for (size_t i = 0; i < corpus.size(); i++) {
+        const collisionState *c = &corpus[i];
+        corpusBad += differs(c);
+        loadState(c);
+        legacyCollision();
+        hits += G::ballVec[0] != c->ballVec[0];
+        if ((c->ballLoc[0] >= c->player1Loc[0] && c->ballLoc[0] <= c->player1Loc[1]) ||
+            (c->ballLoc[1] >= c->player2Loc[0] && c->ballLoc[1] <= c->player2Loc[1])) {
+            near.push_back(*c);
+        }
+    }
+    unsigned long checked = 0;
+    unsigned long sweepBad = sweep(&checked);
+
+    printf("zones: %d, deflection table: %u entries\n", PADDLE_ZONES, G::Deflect::SIZE);
+    printf("corpus: %zu states (%zu in a paddle column, %lu hits), %lu differ\n", corpus.size(), near.size(), hits, corpusBad);
+    printf("sweep: %lu states, %lu differ\n", checked, sweepBad);
+    const std::vector<collisionState> *sets[] = {&corpus, &near};
+    const char *names[] = {"all states", "paddle column"};
+    for (int i = 0; i < 2; i++) {
+        unsigned long setReps = reps * (corpus.size() / (sets[i]->size() + 1) + 1);
+        double base = timeCalls([]() { return 0; }, *sets[i], setReps); // state reload and loop overhead
+        double legacy = timeCalls(legacyCollision, *sets[i], setReps) - base;
+        double kernel = timeCalls(G::checkCollision, *sets[i], setReps) - base;
+        printf("%s: legacy %.2f %s/call, kernel %.2f %s/call\n", names[i], legacy, TIME_UNIT, kernel, TIME_UNIT);
+    }
+    return (corpusBad || sweepBad) && PADDLE_ZONES == 3 ? 1 : 0;
+}
@@ -0,0 +1,135 @@
+// Host-side frame capture for the [env:native] build. Runs the real game tasks
+// against the ST7735 emulator on a scripted input sequence, one frame per
+// scheduler tick, and reports SPI bytes per frame.
+//
+// usage: frames [-n ticks] [-e every] [-o outdir] [-g goldendir] [-v] [-d spi|fb|null]
+//   -n  scheduler ticks to run (default 400, i.e. 10 s of game time at 25 ms per tick)
+//   -e  dump/compare every Nth frame (default 40)
+//   -o  write frame_NNNNN.ppm files into outdir
+//   -g  compare the same frames against PPMs in goldendir, exit 1 on mismatch
+//   -v  print per-frame counters as CSV
+//   -d  display backend: spi (default) drives the real ST7735 driver through the
+//       emulator, fb fills the emulator framebuffer directly, null draws nothing
+#define TICK_STATS // the run summary reports tick timing
+
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "ST7735Emu.h"
+#include "host_backends.h"
+#include "game.h"
+#include "backends.h"
+#include "boot.h"
+
+typedef Game<AvrDisplay, PotInput, HostClock> SpiGame;
+typedef Game<FramebufferDisplay, PotInput, HostClock> FramebufferGame;
+typedef Game<NullDisplay, PotInput, HostClock> HeadlessGame;
+
+unsigned long ticks = 400;
+unsigned long every = 40;
+const char *outDir = 0;
+const char *goldenDir = 0;
+int verbose = 0;
+
+/* Scripted inputs at ms of game time: press start at 0.5 s, sweep both pots. */
+void scriptInputs(unsigned long ms) {
+    PINC = SetBit(PINC, 3, ms >= 500 && ms < 700);
+    unsigned long phase = (ms * 16 / 25) % 2048;
+    host_adc[1] = phase < 1024 ? phase : 2047 - phase;
+    host_adc[2] = 1023 - host_adc[1];
+}
+
+/* Runs G for the requested ticks, dumping/comparing frames. Returns the exit code. */
+template <class G>
+int runGame() {
+    emuStats boot = st7735emu.endFrame();
+    unsigned long long bootUs = host_clock_us;
+    G::initTasks();
+    const unsigned long long periodUs = G::GCD_PERIOD * 1000ULL;
+    unsigned long long nextTickUs = host_clock_us + periodUs;
+    unsigned long long busyUs = 0;
+
+    unsigned long maxBytes = 0;
+    unsigned long mismatches = 0;
+    char path[512];
+    struct timespec wallStart, wallEnd;
+    clock_gettime(CLOCK_MONOTONIC, &wallStart);
+    if (verbose) { printf("frame,bytes,commands,pixels,overdrawn\n"); }
+    for (unsigned long t = 0; t < ticks; t++) {
+        scriptInputs(t * G::GCD_PERIOD);
+        unsigned long long tickStartUs = host_clock_us;
+        G::tick();
+        busyUs += host_clock_us - tickStartUs;
+        // idle until the timer's next compare match; an overrun tick misses the ones it covered
+        while (nextTickUs <= host_clock_us) { nextTickUs += periodUs; }
+        host_clock_us = nextTickUs;
+        emuStats f = st7735emu.endFrame();
+        if (f.bytes > maxBytes) { maxBytes = f.bytes; }
+        if (verbose) { printf("%lu,%lu,%lu,%lu,%lu\n", t, f.bytes, f.commands, f.pixels, f.overdrawn); }
+
+        if (t % every != 0) { continue; }
+        if (outDir) {
+            snprintf(path, sizeof(path), "%s/frame_%05lu.ppm", outDir, t);
+            if (st7735emu.writePPM(path) != 0) { fprintf(stderr, "cannot write %s\n", path); return 2; }
+        }
+        if (goldenDir) {
+            snprintf(path, sizeof(path), "%s/frame_%05lu.ppm", goldenDir, t);
+            long diff = st7735emu.comparePPM(path);
+            if (diff != 0) {
+                mismatches++;
+                fprintf(stderr, "%s: %ld pixels differ\n", path, diff);
+            }
+        }
+    }
+    clock_gettime(CLOCK_MONOTONIC, &wallEnd);
+    double wall = (wallEnd.tv_sec - wallStart.tv_sec) + (wallEnd.tv_nsec - wallStart.tv_nsec) / 1e9;
+
+    emuStats total = st7735emu.total;
+    fprintf(stderr, "boot: %lu bytes, %lu commands, %llu ms busy, first frame at %u ms\n",
+            boot.bytes, boot.commands, bootUs / 1000, bootTimeMs);
+    fprintf(stderr, "frames: %lu in %.3f s wall clock (%.0f ticks/s)\n", ticks, wall, wall > 0 ? ticks / wall : 0.0);
+    fprintf(stderr, "spi bytes: %lu total, %lu per frame avg, %lu max\n",
+            total.bytes - boot.bytes, ticks ? (total.bytes - boot.bytes) / ticks : 0, maxBytes);
+    fprintf(stderr, "commands: %lu, pixels: %lu, overdrawn: %lu\n",
+            total.commands - boot.commands, total.pixels - boot.pixels, total.overdrawn - boot.overdrawn);
+    fprintf(stderr, "busy (delays and SPI): %llu ms, longest tick %lu us\n", busyUs / 1000, G::maxTickUs);
+    fprintf(stderr, "rate: %u Hz achieved at %lu ms period, %u overruns, shed info %u medal %u ai %u\n",
+            G::frameHz, G::GCD_PERIOD, G::overruns,
+            G::shedCount[G::SHED_INFO], G::shedCount[G::SHED_MEDAL], G::shedCount[G::SHED_AI]);
+    if (goldenDir && mismatches) {
+        fprintf(stderr, "%lu golden frame(s) differ\n", mismatches);
+        return 1;
+    }
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    const char *display = "spi";
+    int opt;
+    while ((opt = getopt(argc, argv, "n:e:o:g:vd:")) != -1) {
+        switch (opt) {
+            case 'n': ticks = strtoul(optarg, 0, 10); break;
+            case 'e': every = strtoul(optarg, 0, 10); break;
+            case 'o': outDir = optarg; break;
+            case 'g': goldenDir = optarg; break;
+            case 'v': verbose = 1; break;
+            case 'd': display = optarg; break;
+            default:
+                fprintf(stderr, "usage: %s [-n ticks] [-e every] [-o outdir] [-g goldendir] [-v] [-d spi|fb|null]\n", argv[0]);
+                return 2;
+        }
+    }
+    if (every == 0) { every = 1; }
+
+    st7735emu_attach();
+    SPI_INIT();
+    boot_run();
+    if (strcmp(display, "fb") == 0) { return runGame<FramebufferGame>(); }
+    if (strcmp(display, "null") == 0) {
+        outDir = 0;
+        goldenDir = 0;
+        return runGame<HeadlessGame>();
+    }
+    return runGame<SpiGame>();
+}
@@ -0,0 +1,98 @@
+// Host-side lockstep test for the [env:native_lockstep] build. Two instances are
+// joined through a pseudo-terminal pair standing in for the UART link; each runs
+// the game with its own scripted paddle input and reports state checksums.
+//
+// usage: lockstep_link -m [-n ticks] [-x tick]         create the pty pair, drive paddle 1
+//        lockstep_link -p /dev/pts/N [-n ticks] [-x tick]  join it, drive paddle 2
+//   -n  simulated ticks to run (default 800)
+//   -x  corrupt the local ball vector at this tick to check desync detection
+// Exits 1 if a desync was detected.
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <termios.h>
+#include <unistd.h>
+#include "ST7735Emu.h"
+#include "host_backends.h"
+#include "game.h"
+#include "backends.h"
+#include "boot.h"
+
+typedef Game<AvrDisplay, LockstepInput, HostClock> PingPong;
+
+/* Scripted inputs for simulated tick t. Paddle 1 presses start at 0.5 s. */
+void scriptInputs(unsigned long t) {
+    unsigned long phase = (t * (lsRole == 1 ? 16 : 11)) % 2048;
+    host_adc[lsRole] = phase < 1024 ? phase : 2047 - phase;
+    PINC = SetBit(PINC, 3, lsRole == 1 && t >= 20 && t < 28);
+}
+
+int main(int argc, char **argv) {
+    unsigned long ticks = 800;
+    unsigned long corruptAt = 0;
+    int master = 0;
+    const char *path = 0;
+    int opt;
+    while ((opt = getopt(argc, argv, "mp:n:x:")) != -1) {
+        switch (opt) {
+            case 'm': master = 1; break;
+            case 'p': path = optarg; break;
+            case 'n': ticks = strtoul(optarg, 0, 10); break;
+            case 'x': corruptAt = strtoul(optarg, 0, 10); break;
+            default: path = 0; master = 0; break;
+        }
+    }
+    if (master == (path != 0)) {
+        fprintf(stderr, "usage: %s -m | -p ptyname [-n ticks] [-x tick]\n", argv[0]);
+        return 2;
+    }
+
+    if (master) {
+        host_uart_fd = posix_openpt(O_RDWR | O_NOCTTY);
+        if (host_uart_fd < 0 || grantpt(host_uart_fd) != 0 || unlockpt(host_uart_fd) != 0) {
+            perror("posix_openpt");
+            return 2;
+        }
+        printf("%s\n", ptsname(host_uart_fd));
+        fflush(stdout);
+    } else {
+        host_uart_fd = open(path, O_RDWR | O_NOCTTY);
+        if (host_uart_fd < 0) { perror(path); return 2; }
+    }
+    struct termios raw;
+    if (tcgetattr(host_uart_fd, &raw) == 0) {
+        cfmakeraw(&raw);
+        tcsetattr(host_uart_fd, TCSANOW, &raw);
+    }
+
+    st7735emu_attach();
+    SPI_INIT();
+    boot_run();
+    PingPong::initTasks();
+    lockstep_init(master ? 1 : 2);
+
+    unsigned long stalls = 0;
+    while (lsTick < ticks) {
+        lockstep_receive();
+        scriptInputs(lsSent);
+        unsigned long before = lsTick;
+        lockstepTick<PingPong>();
+        st7735emu.endFrame();
+        if (lsTick == before) {
+            stalls++;
+            usleep(1000);
+            continue;
+        }
+        if (corruptAt && lsTick == corruptAt) { PingPong::ballVec[1] = -PingPong::ballVec[1]; }
+        if (lsTick % 40 == 0) {
+            printf("P%d tick %lu checksum %02x score %d-%d\n", lsRole, lsTick, PingPong::gameChecksum(), PingPong::player1Score, PingPong::player2Score);
+        }
+        if (lsDesync) { break; }
+    }
+
+    printf("P%d %s at tick %lu, checksum %02x, %lu stalled ticks\n",
+           lsRole, lsDesync ? "DESYNC" : "in sync", lsTick, PingPong::gameChecksum(), stalls);
+    // let the other side collect our last inputs before the pty goes away
+    sleep(1);
+    return lsDesync ? 1 : 0;
+}
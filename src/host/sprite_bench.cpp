@@ -0,0 +1,137 @@
+// Host-side check and benchmark for the RLE sprite blitter, for the
+// [env:native_sprite] build. For each sprite in sprites.h it
+//   - draws it with displaySprite() and with an unencoded blit of the same
+//     pixels into the ST7735 emulator, and checks the two pictures match,
+//   - compares flash bytes and SPI bytes for the two, and a solid fill of the
+//     same window,
+//   - times the CPU side of all three with the SPI hook detached, in TSC
+//     cycles on x86 hosts (ns elsewhere).
+//
+// usage: sprite_bench [-k reps]
+//   -k  timed draws per sprite (default 2000)
+// Exits 1 if a sprite does not match its unencoded version.
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <vector>
+#include "ST7735Emu.h"
+#include "ST7735_LCD.h"
+#include "sprites.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+const char *TIME_UNIT = "cycles";
+unsigned long long now(void) { return __rdtsc(); }
+#else
+const char *TIME_UNIT = "ns";
+unsigned long long now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+#endif
+
+/* Expands a sprite into one RGB565 value per pixel: the unencoded form. */
+std::vector<unsigned short> decode(const sprite *s, const unsigned short *palette) {
+    std::vector<unsigned short> pixels;
+    if (!palette) { palette = s->palette; }
+    for (unsigned int i = 0; i < s->runCount; i++) {
+        unsigned char run = s->runs[i];
+        pixels.insert(pixels.end(), SPRITE_RUN_LENGTH(run), palette[SPRITE_RUN_INDEX(run)]);
+    }
+    return pixels;
+}
+
+/* Unencoded blit: the window, then two bytes per stored pixel. */
+void displayBitmap(unsigned char xs, unsigned char ys, unsigned char w, unsigned char h, const unsigned short *pixels) {
+    displayWindow(xs, xs + w - 1, ys, ys + h - 1);
+    for (unsigned int i = 0; i < (unsigned int)w * h; i++) {
+        unsigned short color = pgm_read_word(&pixels[i]);
+        Send_Data(color >> 8);
+        Send_Data(color & 0x00FF);
+    }
+}
+
+typedef struct _spriteCase {
+    const char *name;
+    const sprite *s;
+    const unsigned short *palette;
+} spriteCase;
+
+int main(int argc, char **argv) {
+    unsigned long reps = 2000;
+    int opt;
+    while ((opt = getopt(argc, argv, "k:")) != -1) {
+        switch (opt) {
+            case 'k': reps = strtoul(optarg, 0, 10); break;
+            default:
+                fprintf(stderr, "usage: %s [-k reps]\n", argv[0]);
+                return 2;
+        }
+    }
+
+    const spriteCase cases[] = {
+        {"ball", &ballSprite, 0},
+        {"medal", &medalSprite, 0},
+        {"bronze medal", &medalSprite, bronzePalette},
+        {"title", &titleSprite, 0},
+    };
+    int mismatches = 0;
+
+    st7735emu_attach();
+    Send_Command(COLMOD);
+    Send_Data(0x05);
+    printf("%-13s %7s %11s %11s %9s %12s %12s %12s\n", "sprite", "pixels", "flash rle", "flash raw",
+           "spi bytes", "rle", "raw", "fill");
+    for (unsigned int c = 0; c < sizeof(cases) / sizeof(cases[0]); c++) {
+        const sprite *s = cases[c].s;
+        std::vector<unsigned short> raw = decode(s, cases[c].palette);
+        unsigned int pixels = s->width * s->height;
+        if (raw.size() != pixels) {
+            fprintf(stderr, "%s: runs cover %zu pixels, expected %u\n", cases[c].name, raw.size(), pixels);
+            mismatches++;
+            continue;
+        }
+
+        // same picture both ways, drawn over garbage
+        static unsigned short encoded[EMU_WIDTH * EMU_HEIGHT];
+        for (unsigned int i = 0; i < EMU_WIDTH * EMU_HEIGHT; i++) { st7735emu.fb[i] = i * 7919; }
+        st7735emu.endFrame();
+        displaySprite(3, 5, s, cases[c].palette);
+        emuStats rle = st7735emu.endFrame();
+        memcpy(encoded, st7735emu.fb, sizeof(encoded));
+        for (unsigned int i = 0; i < EMU_WIDTH * EMU_HEIGHT; i++) { st7735emu.fb[i] = i * 7919; }
+        displayBitmap(3, 5, s->width, s->height, raw.data());
+        emuStats bitmap = st7735emu.endFrame();
+        if (memcmp(encoded, st7735emu.fb, sizeof(encoded)) != 0 || rle.bytes != bitmap.bytes) {
+            fprintf(stderr, "%s: RLE blit differs from the unencoded blit\n", cases[c].name);
+            mismatches++;
+        }
+
+        // CPU time of each blit, without the emulator
+        host_spi_hook = 0;
+        unsigned long long t0 = now();
+        for (unsigned long r = 0; r < reps; r++) { displaySprite(3, 5, s, cases[c].palette); }
+        unsigned long long t1 = now();
+        for (unsigned long r = 0; r < reps; r++) { displayBitmap(3, 5, s->width, s->height, raw.data()); }
+        unsigned long long t2 = now();
+        for (unsigned long r = 0; r < reps; r++) { displayBlock(3, 3 + s->width - 1, 5, 5 + s->height - 1, 0x0000); }
+        unsigned long long t3 = now();
+        st7735emu_attach();
+        Send_Command(COLMOD);
+        Send_Data(0x05);
+
+        unsigned int palette = 0;
+        for (unsigned int i = 0; i < s->runCount; i++) {
+            if (SPRITE_RUN_INDEX(s->runs[i]) + 1u > palette) { palette = SPRITE_RUN_INDEX(s->runs[i]) + 1; }
+        }
+        unsigned int flashRle = cases[c].palette ? palette * 2 : s->runCount + palette * 2 + sizeof(sprite);
+        printf("%-13s %7u %11u %11u %9lu %12.0f %12.0f %12.0f\n", cases[c].name, pixels, flashRle, pixels * 2,
+               rle.bytes, (double)(t1 - t0) / reps, (double)(t2 - t1) / reps, (double)(t3 - t2) / reps);
+    }
+    printf("flash in bytes (RLE counts runs, palette and header; the recolored medal only adds its palette)\n");
+    printf("rle/raw/fill: %s per draw, CPU side only\n", TIME_UNIT);
+    return mismatches ? 1 : 0;
+}